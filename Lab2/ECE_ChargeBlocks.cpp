@@ -0,0 +1,161 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Charge block source file. With equal charges the centroid is also the center of charge, so the
+dipole term of the far-field expansion vanishes and the point-charge approximation of a block
+is off by at most about (theta / 2)^2 of its field.
+
+*/
+
+//directives
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include "ECE_ChargeBlocks.h"
+
+using namespace std;
+
+static uint64_t spreadBits(uint64_t v) //puts the low 21 bits of v at every third bit position
+{
+    v &= 0x1FFFFF;
+    v = (v | (v << 32)) & 0x1F00000000FFFFull;
+    v = (v | (v << 16)) & 0x1F0000FF0000FFull;
+    v = (v | (v << 8)) & 0x100F00F00F00F00Full;
+    v = (v | (v << 4)) & 0x10C30C30C30C30C3ull;
+    v = (v | (v << 2)) & 0x1249249249249249ull;
+    return v;
+}
+
+void sortMorton(vector<ECE_ElectricField>& array)
+{
+    if (array.empty())
+    {
+        return;
+    }
+
+    double lo[3] = {array[0].getX(), array[0].getY(), array[0].getZ()};
+    double hi[3] = {lo[0], lo[1], lo[2]};
+    for (auto& charge : array)
+    {
+        double p[3] = {charge.getX(), charge.getY(), charge.getZ()};
+        for (int d = 0; d < 3; d++)
+        {
+            lo[d] = min(lo[d], p[d]);
+            hi[d] = max(hi[d], p[d]);
+        }
+    }
+
+    //each coordinate scaled onto 21 bits, a flat dimension (z of the grid) maps to 0
+    const double CELLS = 2097151.0;
+    vector<pair<uint64_t, size_t>> keys(array.size());
+    for (size_t i = 0; i < array.size(); i++)
+    {
+        double p[3] = {array[i].getX(), array[i].getY(), array[i].getZ()};
+        uint64_t code = 0;
+        for (int d = 0; d < 3; d++)
+        {
+            double span = hi[d] - lo[d];
+            uint64_t cell = span > 0.0 ? static_cast<uint64_t>((p[d] - lo[d]) / span * CELLS) : 0;
+            code |= spreadBits(cell) << d;
+        }
+        keys[i] = {code, i};
+    }
+    sort(keys.begin(), keys.end());
+
+    vector<ECE_ElectricField> sorted;
+    sorted.reserve(array.size());
+    for (auto& key : keys)
+    {
+        sorted.push_back(array[key.second]);
+    }
+    array.swap(sorted);
+}
+
+vector<ChargeBlock> buildBlocks(const vector<ECE_ElectricField>& array, size_t blockSize)
+{
+    vector<ChargeBlock> blocks;
+    for (size_t first = 0; first < array.size(); first += blockSize)
+    {
+        ChargeBlock block;
+        block.first = first;
+        block.last = min(first + blockSize, array.size());
+        block.minX = block.maxX = array[first].getX();
+        block.minY = block.maxY = array[first].getY();
+        block.minZ = block.maxZ = array[first].getZ();
+        block.cx = block.cy = block.cz = block.charge = 0.0;
+
+        for (size_t i = block.first; i < block.last; i++)
+        {
+            const ECE_ElectricField& charge = array[i];
+            block.minX = min(block.minX, charge.getX());
+            block.maxX = max(block.maxX, charge.getX());
+            block.minY = min(block.minY, charge.getY());
+            block.maxY = max(block.maxY, charge.getY());
+            block.minZ = min(block.minZ, charge.getZ());
+            block.maxZ = max(block.maxZ, charge.getZ());
+            block.cx += charge.getQ() * charge.getX();
+            block.cy += charge.getQ() * charge.getY();
+            block.cz += charge.getQ() * charge.getZ();
+            block.charge += charge.getQ();
+        }
+
+        if (block.charge != 0.0)
+        {
+            block.cx /= block.charge;
+            block.cy /= block.charge;
+            block.cz /= block.charge;
+        }
+        else //no center of charge, the block is always summed exactly
+        {
+            block.cx = 0.5 * (block.minX + block.maxX);
+            block.cy = 0.5 * (block.minY + block.maxY);
+            block.cz = 0.5 * (block.minZ + block.maxZ);
+        }
+        blocks.push_back(block);
+    }
+    return blocks;
+}
+
+void addBlockField(const ChargeBlock& block, vector<ECE_ElectricField>& charges, double x, double y, double z, double theta,
+                   double &Ex, double &Ey, double &Ez)
+{
+    double dx = x - block.cx;
+    double dy = y - block.cy;
+    double dz = z - block.cz;
+    double r2 = dx * dx + dy * dy + dz * dz;
+    double sx = block.maxX - block.minX;
+    double sy = block.maxY - block.minY;
+    double sz = block.maxZ - block.minZ;
+    double size2 = sx * sx + sy * sy + sz * sz; //squared diagonal of the box
+
+    //distance from the probe to the nearest point of the box, zero inside it: a probe beside or inside a block is
+    //close to some of its charges however far the centroid is, so it never passes as far field
+    double gx = max(max(block.minX - x, x - block.maxX), 0.0);
+    double gy = max(max(block.minY - y, y - block.maxY), 0.0);
+    double gz = max(max(block.minZ - z, z - block.maxZ), 0.0);
+    double gap2 = gx * gx + gy * gy + gz * gz;
+
+    if (block.charge != 0.0 && size2 < theta * theta * gap2) //far field, the whole block as one charge
+    {
+        double k = 8.99e9; // Coulomb's constant
+        double r = sqrt(r2);
+        double scale = k * block.charge / (r2 * r);
+        Ex += scale * dx;
+        Ey += scale * dy;
+        Ez += scale * dz;
+        return;
+    }
+
+    for (size_t i = block.first; i < block.last; i++) //near field, every charge exactly
+    {
+        double cEx, cEy, cEz;
+        charges[i].computeFieldAt(x, y, z);
+        charges[i].getElectricField(cEx, cEy, cEz);
+        Ex += cEx;
+        Ey += cEy;
+        Ez += cEz;
+    }
+}
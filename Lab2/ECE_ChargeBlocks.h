@@ -0,0 +1,42 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for charge blocks. Charges are sorted along a Morton (Z-order) curve so charges
+close in space are close in memory, then cut into blocks with a bounding box, total charge and
+centroid. A probe far enough from a block sees the block's field as that of one point charge at
+its centroid; closer probes sum the block's charges exactly.
+
+*/
+
+#ifndef LAB2_ECE_CHARGEBLOCKS_H
+#define LAB2_ECE_CHARGEBLOCKS_H
+
+//directives
+#include <vector>
+#include <cstddef>
+#include "ECE_ElectricField.h"
+
+const std::size_t BLOCK_SIZE = 128; //charges per block, a block's charges fit in L1 cache
+
+struct ChargeBlock //consecutive charges [first, last) of an array sorted by sortMorton
+{
+    std::size_t first;
+    std::size_t last;
+    double minX, minY, minZ; //bounding box
+    double maxX, maxY, maxZ;
+    double cx, cy, cz; //charge-weighted centroid
+    double charge; //total charge
+};
+
+void sortMorton(std::vector<ECE_ElectricField>& array); //reorders charges along a Morton curve over their bounding box
+std::vector<ChargeBlock> buildBlocks(const std::vector<ECE_ElectricField>& array, std::size_t blockSize); //cuts a sorted array into blocks
+
+//adds the field of block's charges at (x, y, z) to Ex, Ey, Ez, using one point charge at the centroid when the
+//block's diagonal is below theta times the distance to its bounding box; theta = 0, or a probe inside the box, sums exactly
+void addBlockField(const ChargeBlock& block, std::vector<ECE_ElectricField>& charges, double x, double y, double z, double theta,
+                   double &Ex, double &Ey, double &Ez);
+
+#endif
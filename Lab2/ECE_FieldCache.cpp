@@ -0,0 +1,110 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Field cache source file. A hit moves its entry to the front of the list, so the entry at the
+back is always the least recently used one and is the one evicted when the cache is full.
+
+*/
+
+//directives
+#include <cmath>
+#include "ECE_FieldCache.h"
+
+using namespace std;
+
+const double MAX_QUANTA = 9.0e18; //llround is undefined once the result passes INT64_MAX (about 9.22e18)
+
+ECE_FieldCache::ECE_FieldCache(size_t capacity, double quantum): capacity(capacity), quantum(quantum) {} //initializing the constructor
+
+size_t ECE_FieldCache::KeyHash::operator()(const Key &key) const //mixing the three coordinates
+{
+    uint64_t h = static_cast<uint64_t>(key.x) * 0x9E3779B97F4A7C15ull;
+    h ^= static_cast<uint64_t>(key.y) * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+    h ^= static_cast<uint64_t>(key.z) * 0x165667B19E3779F9ull + (h << 6) + (h >> 2);
+    return static_cast<size_t>(h);
+}
+
+bool ECE_FieldCache::quantize(double x, double y, double z, Key &key) const //probes closer than the quantum share a key
+{
+    double qx = x / quantum;
+    double qy = y / quantum;
+    double qz = z / quantum;
+    if (!(fabs(qx) < MAX_QUANTA && fabs(qy) < MAX_QUANTA && fabs(qz) < MAX_QUANTA)) //also rejects NaN and infinity
+    {
+        return false;
+    }
+    key = {llround(qx), llround(qy), llround(qz)};
+    return true;
+}
+
+void ECE_FieldCache::checkVersion(uint64_t version)
+{
+    if (version != this->version) //results for an old grid or charge are never served
+    {
+        entries.clear();
+        index.clear();
+        this->version = version;
+    }
+}
+
+bool ECE_FieldCache::lookup(double x, double y, double z, uint64_t version, double &Ex, double &Ey, double &Ez)
+{
+    lock_guard<mutex> lock(cacheMutex);
+    checkVersion(version);
+
+    Key key;
+    auto found = quantize(x, y, z, key) ? index.find(key) : index.end();
+    if (found == index.end())
+    {
+        misses++;
+        return false;
+    }
+    entries.splice(entries.begin(), entries, found->second); //now the most recently used
+    Ex = found->second->Ex;
+    Ey = found->second->Ey;
+    Ez = found->second->Ez;
+    hits++;
+    return true;
+}
+
+void ECE_FieldCache::insert(double x, double y, double z, uint64_t version, double Ex, double Ey, double Ez)
+{
+    lock_guard<mutex> lock(cacheMutex);
+    checkVersion(version);
+    Key key;
+    if (capacity == 0 || !quantize(x, y, z, key)) //nothing to key it on, computed fresh every time
+    {
+        return;
+    }
+
+    auto found = index.find(key);
+    if (found != index.end()) //another thread computed the same location first
+    {
+        entries.splice(entries.begin(), entries, found->second);
+        *found->second = {key, Ex, Ey, Ez};
+        return;
+    }
+
+    if (entries.size() >= capacity) //evicting the least recently used entry
+    {
+        index.erase(entries.back().key);
+        entries.pop_back();
+    }
+    entries.push_front({key, Ex, Ey, Ez});
+    index[key] = entries.begin();
+}
+
+uint64_t ECE_FieldCache::getHits() const
+{
+    lock_guard<mutex> lock(cacheMutex);
+    return hits;
+}
+
+uint64_t ECE_FieldCache::getMisses() const
+{
+    lock_guard<mutex> lock(cacheMutex);
+    return misses;
+}
@@ -0,0 +1,68 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for the electric field cache. Results are kept for the most recently used probe
+locations, keyed on the location rounded to a fixed quantum, and are only valid for the grid
+version they were computed with. Locations too far out to count in quanta (about 9e9 m at a
+nanometer) bypass the cache.
+
+*/
+
+#ifndef LAB2_ECE_FIELDCACHE_H
+#define LAB2_ECE_FIELDCACHE_H
+
+//directives
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+class ECE_FieldCache //bounded, thread-safe LRU cache of field results
+{
+public:
+    ECE_FieldCache(std::size_t capacity, double quantum); //capacity in entries, quantum in meters
+    bool lookup(double x, double y, double z, uint64_t version, double &Ex, double &Ey, double &Ez); //true and fills Ex, Ey, Ez on a hit
+    void insert(double x, double y, double z, uint64_t version, double Ex, double Ey, double Ez); //stores a result, evicting the least recently used one if full
+    [[nodiscard]] uint64_t getHits() const; //get functions for the statistics
+    [[nodiscard]] uint64_t getMisses() const;
+
+private:
+    struct Key //probe location in multiples of the quantum
+    {
+        int64_t x;
+        int64_t y;
+        int64_t z;
+        bool operator==(const Key &other) const {return x == other.x && y == other.y && z == other.z;}
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key &key) const;
+    };
+
+    struct Entry
+    {
+        Key key;
+        double Ex;
+        double Ey;
+        double Ez;
+    };
+
+    bool quantize(double x, double y, double z, Key &key) const; //false if a coordinate has no key
+    void checkVersion(uint64_t version); //drops every entry if the grid changed, called with the mutex held
+
+    std::size_t capacity;
+    double quantum;
+    uint64_t version = 0; //grid version the entries belong to
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    std::list<Entry> entries; //most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    mutable std::mutex cacheMutex;
+};
+
+#endif
@@ -18,4 +18,5 @@ ECE_PointCharge::ECE_PointCharge(double x, double y, double z, double q): x(x),
 double ECE_PointCharge::getX() const {return x;} //returning coordinates of point charge
 double ECE_PointCharge::getY() const {return y;}
 double ECE_PointCharge::getZ() const {return z;}
+double ECE_PointCharge::getQ() const {return q;} //returning charge of point charge
 
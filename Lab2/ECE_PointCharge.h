@@ -18,6 +18,7 @@ public: //functions
     [[nodiscard]] double getX() const; //get functions to check position of point charge
     [[nodiscard]] double getY() const;
     [[nodiscard]] double getZ() const;
+    [[nodiscard]] double getQ() const; //get function for the charge
 
 protected:
     double x; //x-coordinate
@@ -0,0 +1,217 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Thread layout source file. The topology comes from /sys, so no NUMA library is needed; without
+it every allowed CPU is treated as one node.
+
+*/
+
+//directives
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <utility>
+#include <cstring>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+#include "ECE_ThreadLayout.h"
+
+using namespace std;
+
+static vector<int> parseCpuList(const string& path) //reads a list such as "0-63,128-191", empty if the file is missing
+{
+    vector<int> cpus;
+    ifstream file(path);
+    string list;
+    if (!(file >> list))
+    {
+        return cpus;
+    }
+
+    stringstream ranges(list);
+    string range;
+    while (getline(ranges, range, ','))
+    {
+        int first = 0, last = 0;
+        if (sscanf(range.c_str(), "%d-%d", &first, &last) == 1)
+        {
+            last = first;
+        }
+        for (int cpu = first; cpu <= last; cpu++)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+static int siblingRank(int cpu) //0 for the first hardware thread of a core, 1 for the second, ...
+{
+    vector<int> siblings = parseCpuList("/sys/devices/system/cpu/cpu" + to_string(cpu) + "/topology/thread_siblings_list");
+    auto found = find(siblings.begin(), siblings.end(), cpu);
+    return found == siblings.end() ? 0 : static_cast<int>(found - siblings.begin());
+}
+
+ECE_ThreadLayout::ECE_ThreadLayout(int requested, AffinityPolicy policy): policy(policy)
+{
+    //CPUs this process may use, which respects taskset and container limits
+    vector<int> allowed;
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &mask))
+            {
+                allowed.push_back(cpu);
+            }
+        }
+    }
+    if (allowed.empty())
+    {
+        for (int cpu = 0; cpu < static_cast<int>(max(1u, thread::hardware_concurrency())); cpu++)
+        {
+            allowed.push_back(cpu);
+        }
+    }
+
+    //grouping the allowed CPUs by NUMA node
+    for (int node = 0; ; node++)
+    {
+        string path = "/sys/devices/system/node/node" + to_string(node) + "/cpulist";
+        if (!ifstream(path)) //past the last node, or no node information at all
+        {
+            break;
+        }
+        vector<int> cpus = parseCpuList(path); //empty for a node with memory only
+        vector<int> usable;
+        for (int cpu : cpus)
+        {
+            if (find(allowed.begin(), allowed.end(), cpu) != allowed.end())
+            {
+                usable.push_back(cpu);
+            }
+        }
+        if (!usable.empty())
+        {
+            nodes.push_back(usable);
+        }
+    }
+    if (nodes.empty())
+    {
+        nodes.push_back(allowed);
+    }
+    for (auto& cpus : nodes) //one thread per physical core before any core gets a second
+    {
+        vector<pair<int, int>> ranked; //(sibling rank, cpu), each rank read from sysfs once
+        for (int cpu : cpus)
+        {
+            ranked.emplace_back(siblingRank(cpu), cpu);
+        }
+        stable_sort(ranked.begin(), ranked.end(), [](const pair<int, int>& a, const pair<int, int>& b) {return a.first < b.first;});
+        for (size_t i = 0; i < cpus.size(); i++)
+        {
+            cpus[i] = ranked[i].second;
+        }
+    }
+
+    int cpuCount = getCpus();
+    threads = (requested <= 0 || requested > cpuCount) ? cpuCount : requested;
+
+    //how many threads go to each node
+    vector<int> perNode(nodes.size(), 0);
+    if (policy == AFFINITY_SPREAD)
+    {
+        int given = 0;
+        for (size_t n = 0; n < nodes.size(); n++)
+        {
+            perNode[n] = static_cast<int>(static_cast<long long>(threads) * nodes[n].size() / cpuCount);
+            given += perNode[n];
+        }
+        for (size_t n = 0; given < threads; n = (n + 1) % nodes.size()) //remainder to the nodes with free CPUs
+        {
+            if (perNode[n] < static_cast<int>(nodes[n].size()))
+            {
+                perNode[n]++;
+                given++;
+            }
+        }
+    }
+    else //compact, and the node grouping of an unpinned run
+    {
+        int left = threads;
+        for (size_t n = 0; n < nodes.size(); n++)
+        {
+            perNode[n] = min(left, static_cast<int>(nodes[n].size()));
+            left -= perNode[n];
+        }
+    }
+
+    for (size_t n = 0; n < nodes.size(); n++) //threads of a node get consecutive numbers
+    {
+        for (int k = 0; k < perNode[n]; k++)
+        {
+            cpuOf.push_back(policy == AFFINITY_NONE ? -1 : nodes[n][k]);
+            nodeOf.push_back(static_cast<int>(n));
+        }
+    }
+}
+
+int ECE_ThreadLayout::getThreads() const {return threads;} //returning the planned layout
+
+int ECE_ThreadLayout::getCpus() const
+{
+    int count = 0;
+    for (auto& cpus : nodes)
+    {
+        count += static_cast<int>(cpus.size());
+    }
+    return count;
+}
+
+int ECE_ThreadLayout::getNodes() const
+{
+    return nodeOf.empty() ? 1 : nodeOf.back() + 1;
+}
+
+string ECE_ThreadLayout::describe() const
+{
+    const char* names[] = {"no", "compact", "spread"};
+    stringstream line;
+    line << "Using " << threads << " of " << getCpus() << " CPUs on " << getNodes() << " NUMA node(s) with " << names[policy] << " affinity.";
+    return line.str();
+}
+
+void ECE_ThreadLayout::pinCurrentThread(int thread) const
+{
+    static thread_local int pinnedAs = -1; //the OpenMP pool keeps its threads, so this runs once per thread
+    if (pinnedAs == thread || cpuOf[thread] < 0)
+    {
+        return;
+    }
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpuOf[thread], &mask);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0)
+    {
+        pinnedAs = thread;
+    }
+}
+
+AffinityPolicy ECE_ThreadLayout::parsePolicy(const char* name)
+{
+    if (name != nullptr && strcmp(name, "none") == 0)
+    {
+        return AFFINITY_NONE;
+    }
+    if (name != nullptr && strcmp(name, "spread") == 0)
+    {
+        return AFFINITY_SPREAD;
+    }
+    return AFFINITY_COMPACT;
+}
@@ -0,0 +1,48 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for the thread layout. It reads which CPUs the program may run on and which NUMA
+node each belongs to, picks a thread count, and plans which CPU every OpenMP thread is pinned
+to. Threads on the same node get consecutive thread numbers, so consecutive chunks of the charge
+array stay on one node.
+
+*/
+
+#ifndef LAB2_ECE_THREADLAYOUT_H
+#define LAB2_ECE_THREADLAYOUT_H
+
+//directives
+#include <string>
+#include <vector>
+
+enum AffinityPolicy //how threads are placed on CPUs
+{
+    AFFINITY_NONE, //left to the operating system
+    AFFINITY_COMPACT, //fills the cores of one node before the next
+    AFFINITY_SPREAD //shares the threads between nodes by their size
+};
+
+class ECE_ThreadLayout //CPU and NUMA node of every thread
+{
+public:
+    ECE_ThreadLayout(int requested, AffinityPolicy policy); //requested <= 0 or above the CPU count uses one thread per CPU
+    [[nodiscard]] int getThreads() const; //get functions for the planned layout
+    [[nodiscard]] int getCpus() const;
+    [[nodiscard]] int getNodes() const;
+    [[nodiscard]] std::string describe() const; //one line summary for the user
+    void pinCurrentThread(int thread) const; //binds the calling thread to the CPU planned for thread, once per OS thread
+
+    static AffinityPolicy parsePolicy(const char* name); //"none", "compact" or "spread", compact if unset or unknown
+
+private:
+    int threads;
+    AffinityPolicy policy;
+    std::vector<std::vector<int>> nodes; //allowed CPUs of each node, one CPU per physical core first
+    std::vector<int> cpuOf; //planned CPU of each thread, -1 if not pinned
+    std::vector<int> nodeOf; //node of each thread
+};
+
+#endif
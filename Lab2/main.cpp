@@ -1,8 +1,7 @@
-
 /*
 Author: Abby McCollam
 Class: ECE4122 Section A
-Last Date Modified: 10/10/23
+Last Date Modified: 10/19/26
 Description:
 
 Main function prompting user for number of rows and columns, separation distances, charge value, and point location using openmp.
@@ -17,8 +16,13 @@ Main function prompting user for number of rows and columns, separation distance
 #include <chrono>
 #include <istream>
 #include <cmath>
+#include <cstdlib>
+#include <algorithm>
 #include <omp.h>
 #include "ECE_ElectricField.h"
+#include "ECE_FieldCache.h"
+#include "ECE_ThreadLayout.h"
+#include "ECE_ChargeBlocks.h"
 
 using namespace std;
 
@@ -28,6 +32,13 @@ double x_sep, y_sep; //separation distances
 int row, col; //number of rows and columns
 int n_threads; //number of threads
 vector<ECE_ElectricField> myArray; //array of electric fields
+uint64_t gridVersion = 0; //bumped whenever the charges or q change, older cached results are dropped
+ECE_FieldCache fieldCache(4096, 1e-9); //recent probe results, locations within a nanometer share an entry
+ECE_ThreadLayout* layout = nullptr; //CPU and NUMA node of every thread
+vector<ChargeBlock> blocks; //blocks of myArray after it is sorted along a Morton curve
+vector<vector<ECE_ElectricField>> partitions; //each thread's share of myArray, allocated by that thread so it sits on its NUMA node
+vector<vector<ChargeBlock>> partitionBlocks; //blocks of each partition, indexed into that partition
+double theta = 0.0; //far-field threshold from LAB2_THETA, 0 sums every charge exactly
 
 bool checkForNaturalNumber (int a, int b) //checking for valid natural number inputs
 {
@@ -59,6 +70,7 @@ bool checkForPositiveDouble (double a, double b) //checking for valid inputs for
 
 void howToCreate2DArray(vector<ECE_ElectricField>& array, int n, int m, double v) //creating 2D array centered around the origin with the given parameters
 {
+    gridVersion++; //cached fields belong to the previous grid
     for (int i = 0; i<n; i++)
     {
         for (int j = 0; j<m; j++)
@@ -70,6 +82,34 @@ void howToCreate2DArray(vector<ECE_ElectricField>& array, int n, int m, double v
     }
 }
 
+void distributeCharges() //copies each thread's consecutive blocks of myArray into memory local to the thread
+{
+    partitions.assign(n_threads, vector<ECE_ElectricField>());
+    partitionBlocks.assign(n_threads, vector<ChargeBlock>());
+#pragma omp parallel num_threads(n_threads)
+    {
+        layout->pinCurrentThread(omp_get_thread_num());
+#pragma omp for schedule(static, 1) //partition p goes to thread p, and still gets filled if the runtime gives fewer threads
+        for (int p = 0; p < n_threads; p++)
+        {
+            size_t firstBlock = blocks.size() * p / n_threads;
+            size_t lastBlock = blocks.size() * (p + 1) / n_threads;
+            if (firstBlock < lastBlock) //more threads than blocks leaves some partitions without charges
+            {
+                size_t first = blocks[firstBlock].first;
+                partitions[p].assign(myArray.begin() + first, myArray.begin() + blocks[lastBlock - 1].last); //first touch by the owner places the pages on its node
+                for (size_t b = firstBlock; b < lastBlock; b++)
+                {
+                    ChargeBlock block = blocks[b];
+                    block.first -= first;
+                    block.last -= first;
+                    partitionBlocks[p].push_back(block);
+                }
+            }
+        }
+    }
+}
+
 bool CheckForNM() //checking if row and col are natural numbers
 {
     HERE: cout << "Please enter the number of rows and columns in the N x M array: ";
@@ -176,17 +216,33 @@ int main()
 {
     double x, y, z; //point location
 
-    unsigned int n = thread::hardware_concurrency(); //setting n equal to hardware concurrency
-    cout << "Please enter the number of concurrent threads to use: "; //user enters amount of threads to use
+    cout << "Please enter the number of concurrent threads to use (0 for one per CPU): "; //user enters amount of threads to use
     cin >> n_threads;
-    omp_set_num_threads(n_threads); //setting number of threads
+    if (cin.fail()) //anything that is not a number picks the thread count automatically
+    {
+        cin.clear();
+        n_threads = 0;
+    }
     cin.ignore(numeric_limits<streamsize>::max(), '\n'); //ignoring input
 
+    layout = new ECE_ThreadLayout(n_threads, ECE_ThreadLayout::parsePolicy(getenv("LAB2_AFFINITY"))); //LAB2_AFFINITY=none|compact|spread
+    n_threads = layout->getThreads(); //never more threads than CPUs
+    omp_set_num_threads(n_threads); //setting number of threads
+    cout << layout->describe() << endl;
+    if (getenv("LAB2_THETA") != nullptr) //LAB2_THETA=0.2 approximates blocks smaller than 0.2 of their distance
+    {
+        theta = max(0.0, atof(getenv("LAB2_THETA")));
+        cout << "Far-field threshold: " << theta << endl;
+    }
+
     CheckForNM();
     CheckForDist();
     CheckForCharge();
 
     howToCreate2DArray(myArray, row, col, q); //creates 2D array using function
+    sortMorton(myArray); //charges close in space end up close in memory
+    blocks = buildBlocks(myArray, BLOCK_SIZE);
+    distributeCharges();
 
     while (true) //while loop the code is circling through that keeps prompting user for new inputs
     {
@@ -208,32 +264,29 @@ int main()
 	auto end_time = chrono::high_resolution_clock::now(); //end time
 	auto duration = chrono::duration_cast<chrono::microseconds>(end_time - start_time); //calculate time taken
 	//int64_t totalSize = myArray.size(); //size of array
-	double tempEx, tempEy, tempEz; //temp variables
+	double tempEx = 0.0, tempEy = 0.0, tempEz = 0.0; //temp variables
 
-#pragma omp parallel num_threads(n_threads) firstprivate(x,y,z) //start of openmp
-{
+	start_time = chrono::high_resolution_clock::now();
+	bool cached = fieldCache.lookup(x, y, z, gridVersion, tempEx, tempEy, tempEz); //repeated locations skip the sum
 
-#pragma omp master //only find time and print outputs in master thread
+	if (!cached)
+	{
+#pragma omp parallel num_threads(n_threads) firstprivate(x,y,z) reduction(+:tempEx, tempEy, tempEz) //start of openmp
 {
-	start_time = chrono::high_resolution_clock::now();
-}
+	layout->pinCurrentThread(omp_get_thread_num());
+#pragma omp for schedule(static, 1) //same partition to thread mapping as distributeCharges, every partition is summed however many threads run
+	for (int p = 0; p < n_threads; p++)
+	{
+	    vector<ECE_ElectricField>& chunk = partitions[p]; //same chunk every query, so it is still in this core's cache
 
-#pragma omp for
-	for (int i=0; i < myArray.size(); i++)
-        {
-            myArray[i].computeFieldAt(x,y,z); //compute field here
+	    for (auto& block : partitionBlocks[p]) //each thread sums its own blocks, reduced at the end
+            {
+                addBlockField(block, chunk, x, y, z, theta, tempEx, tempEy, tempEz); //compute field here
+            }
 	}
-
-#pragma omp for reduction(+:tempEx, tempEy, tempEz) schedule(static) //breaks into chunks and reduces at end
-        for (int i=0; i < myArray.size(); i++)
-        {
-	    double Ex, Ey, Ez; //declaring variables to sum
-            myArray[i].getElectricField(Ex,Ey,Ez); //retrieving values of fields
-            tempEx += Ex;
-            tempEy += Ey;
-            tempEz += Ez;
-        }
 }
+	fieldCache.insert(x, y, z, gridVersion, tempEx, tempEy, tempEz);
+	}
 
 #pragma omp master //only find time and print outputs in master thread
 {        
@@ -249,12 +302,13 @@ int main()
     	cout << "Ey = " << scientific << tempEy << endl;
     	cout << "Ez = " << scientific << tempEz << endl;
     	cout << "|Ez| = " << scientific << Emag << endl;
-        cout << "The calculation took " << duration.count() << " microseconds!" << endl; //printing total time
+        cout << "The calculation took " << duration.count() << " microseconds!" << (cached ? " (cached)" : "") << endl; //printing total time
 }
 
 	//user responds yes or no
         if (!ContinueFunc())
         {
+            cout << "Field cache: " << fieldCache.getHits() << " hits, " << fieldCache.getMisses() << " misses." << endl;
             break;
         }
         else
@@ -0,0 +1,136 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Connection table source file. Slots are handed out lowest first and freed slots are reused, which
+keeps the timer wheel's keys small and dense.
+
+*/
+
+//directives
+#include "ECE_ConnectionTable.h"
+
+using namespace std;
+
+ECE_ConnectionTable::ECE_ConnectionTable(uint64_t heartbeatTicks, uint64_t idleTicks, size_t slabSize, size_t wheelSize)
+    : slabSize(slabSize), timers(heartbeatTicks, idleTicks, wheelSize) {}
+
+Connection& ECE_ConnectionTable::at(uint32_t slot)
+{
+    return slabs[slot / slabSize][slot % slabSize];
+}
+
+ConnectionId ECE_ConnectionTable::add(uint64_t now)
+{
+    if (freeSlots.empty()) //growing by one slab, existing connections never move
+    {
+        uint32_t base = static_cast<uint32_t>(slabs.size() * slabSize);
+        slabs.emplace_back(new Connection[slabSize]);
+        for (size_t i = slabSize; i > 0; i--) //lowest slots are handed out first
+        {
+            freeSlots.push_back(base + static_cast<uint32_t>(i - 1));
+        }
+    }
+
+    uint32_t slot = freeSlots.back();
+    freeSlots.pop_back();
+
+    Connection& connection = at(slot);
+    connection.inUse = true;
+    connection.features = 0; //a new client starts on the plain protocol
+    connection.pending.clear();
+    connection.replaying = false;
+    connection.held.clear();
+
+    //linking at the head of the active list
+    connection.prevActive = NO_SLOT;
+    connection.nextActive = activeHead;
+    if (activeHead != NO_SLOT)
+    {
+        at(activeHead).prevActive = slot;
+    }
+    activeHead = slot;
+    live++;
+
+    timers.start(slot, now);
+    return {slot, connection.generation};
+}
+
+Connection* ECE_ConnectionTable::get(ConnectionId id)
+{
+    if (id.slot >= slabs.size() * slabSize)
+    {
+        return nullptr;
+    }
+    Connection& connection = at(id.slot);
+    if (!connection.inUse || connection.generation != id.generation) //slot was freed or reused since id was handed out
+    {
+        return nullptr;
+    }
+    return &connection;
+}
+
+void ECE_ConnectionTable::remove(ConnectionId id)
+{
+    Connection* connection = get(id);
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    timers.stop(id.slot);
+
+    //unlinking from the active list
+    if (connection->prevActive != NO_SLOT)
+    {
+        at(connection->prevActive).nextActive = connection->nextActive;
+    }
+    else
+    {
+        activeHead = connection->nextActive;
+    }
+    if (connection->nextActive != NO_SLOT)
+    {
+        at(connection->nextActive).prevActive = connection->prevActive;
+    }
+
+    connection->inUse = false;
+    connection->generation++; //every outstanding copy of id is now stale
+    freeSlots.push_back(id.slot);
+    live--;
+}
+
+void ECE_ConnectionTable::touch(ConnectionId id, uint64_t now)
+{
+    if (get(id) != nullptr)
+    {
+        timers.touch(id.slot, now);
+    }
+}
+
+void ECE_ConnectionTable::advance(uint64_t now, vector<TimerEvent>& events)
+{
+    timers.advance(now, events);
+}
+
+size_t ECE_ConnectionTable::size() const
+{
+    return live;
+}
+
+uint32_t ECE_ConnectionTable::first() const
+{
+    return activeHead;
+}
+
+uint32_t ECE_ConnectionTable::next(uint32_t slot) const
+{
+    return slabs[slot / slabSize][slot % slabSize].nextActive;
+}
+
+ConnectionId ECE_ConnectionTable::idOf(uint32_t slot) const
+{
+    return {slot, slabs[slot / slabSize][slot % slabSize].generation};
+}
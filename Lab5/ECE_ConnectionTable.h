@@ -0,0 +1,83 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for the server's connection table. Connections live in fixed-size slabs so their
+addresses never move, are named by an id of (slot, generation) so a stale id can never reach a
+reused slot, and sit on an ECE_TimerWheel, keyed by slot, that drives heartbeats and idle timeouts.
+
+*/
+
+#ifndef LAB5_ECE_CONNECTIONTABLE_H
+#define LAB5_ECE_CONNECTIONTABLE_H
+
+//directives
+#include <SFML/Network.hpp>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdint>
+#include "ECE_MessageBatch.h"
+#include "ECE_MessageLog.h"
+#include "ECE_TimerWheel.h"
+
+class ClientSocket : public sf::TcpSocket //exposes the native handle so the log can sendfile to the client
+{
+public:
+    using sf::TcpSocket::getHandle;
+};
+
+struct ConnectionId //stable name of a connection, only valid while the generation matches
+{
+    uint32_t slot;
+    uint32_t generation;
+};
+
+const uint32_t NO_SLOT = 0xFFFFFFFF; //end of an intrusive list
+
+struct Connection //one slab slot
+{
+    ClientSocket socket;
+    uint32_t generation = 0; //bumped every time the slot is freed
+    bool inUse = false;
+    unsigned short features = 0; //protocol extensions agreed with a HELLO
+    ECE_MessageBatch pending; //messages for a batching client, sent together at the end of the loop pass
+    bool replaying = false; //history is being streamed, nothing else may be written to the socket
+    ReplayCursor replay; //how far the history has got
+    std::string held; //frames that arrived during the replay, sent once it is done
+
+    //intrusive links, so removal never searches
+    uint32_t prevActive = NO_SLOT;
+    uint32_t nextActive = NO_SLOT;
+};
+
+class ECE_ConnectionTable //slab allocated connections with O(1) add, lookup and removal
+{
+public:
+    ECE_ConnectionTable(uint64_t heartbeatTicks, uint64_t idleTicks, std::size_t slabSize = 64, std::size_t wheelSize = 256); //timeouts are in ticks
+
+    ConnectionId add(uint64_t now); //takes a free slot (growing by a slab if needed) and starts its timer
+    void remove(ConnectionId id); //frees the slot and invalidates every copy of id
+    Connection* get(ConnectionId id); //nullptr if id is stale
+    void touch(ConnectionId id, uint64_t now); //activity on the connection restarts its heartbeat timer
+    void advance(uint64_t now, std::vector<TimerEvent>& events); //fires every timer due up to now, keyed by slot
+
+    [[nodiscard]] std::size_t size() const; //number of live connections
+    [[nodiscard]] uint32_t first() const; //first live slot, for iteration
+    [[nodiscard]] uint32_t next(uint32_t slot) const; //live slot after slot
+    [[nodiscard]] ConnectionId idOf(uint32_t slot) const; //id of a live slot
+    Connection& at(uint32_t slot); //slot lookup without a generation check
+
+private:
+    std::size_t slabSize;
+
+    std::vector<std::unique_ptr<Connection[]>> slabs;
+    std::vector<uint32_t> freeSlots;
+    ECE_TimerWheel timers;
+    uint32_t activeHead = NO_SLOT;
+    std::size_t live = 0;
+};
+
+#endif
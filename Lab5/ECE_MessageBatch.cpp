@@ -0,0 +1,257 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Batch frame source file, with a compressor and decompressor for the LZ4 block format. Chat
+payloads repeat a lot (the same frame header before every message, similar text), which the
+4-byte matches of LZ4 pick up cheaply. The decompressor checks every length against both
+buffers since the input comes from the network.
+
+*/
+
+//directives
+#include <cstring>
+#include <vector>
+#include "ECE_MessageBatch.h"
+
+using namespace std;
+
+static const size_t MIN_MATCH = 4;
+static const size_t LAST_LITERALS = 5; //the format ends every block with literals
+static const size_t MATCH_LIMIT = 12; //no match may start in the last 12 bytes
+static const int HASH_BITS = 12;
+
+static uint32_t read32(const char* p)
+{
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+static bool writeLength(char*& out, char* end, size_t length) //extra length bytes after a nibble of 15
+{
+    for (; length >= 255; length -= 255)
+    {
+        if (out == end)
+        {
+            return false;
+        }
+        *out++ = static_cast<char>(255);
+    }
+    if (out == end)
+    {
+        return false;
+    }
+    *out++ = static_cast<char>(length);
+    return true;
+}
+
+static bool writeSequence(char*& out, char* end, const char* literals, size_t literalCount, size_t offset, size_t matchLength) //matchLength 0 for the last sequence
+{
+    if (out == end)
+    {
+        return false;
+    }
+    char* token = out++;
+    size_t matchCode = matchLength > 0 ? matchLength - MIN_MATCH : 0;
+    *token = static_cast<char>(((literalCount < 15 ? literalCount : 15) << 4) | (matchCode < 15 ? matchCode : 15));
+
+    if (literalCount >= 15 && !writeLength(out, end, literalCount - 15))
+    {
+        return false;
+    }
+    if (static_cast<size_t>(end - out) < literalCount)
+    {
+        return false;
+    }
+    memcpy(out, literals, literalCount);
+    out += literalCount;
+
+    if (matchLength == 0)
+    {
+        return true;
+    }
+    if (end - out < 2)
+    {
+        return false;
+    }
+    *out++ = static_cast<char>(offset & 0xFF); //little-endian, as in LZ4
+    *out++ = static_cast<char>(offset >> 8);
+    return matchCode < 15 || writeLength(out, end, matchCode - 15);
+}
+
+size_t lz4Compress(const char* source, size_t size, char* out, size_t capacity)
+{
+    char* start = out;
+    char* end = out + capacity;
+    size_t anchor = 0; //first byte not yet written
+
+    if (size > MATCH_LIMIT)
+    {
+        vector<int64_t> table(size_t(1) << HASH_BITS, -1); //last position of each hashed 4-byte sequence
+        size_t limit = size - MATCH_LIMIT;
+        size_t i = 0;
+        while (i < limit)
+        {
+            uint32_t sequence = read32(source + i);
+            uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+            int64_t candidate = table[hash];
+            table[hash] = static_cast<int64_t>(i);
+
+            if (candidate < 0 || i - candidate > 65535 || read32(source + candidate) != sequence)
+            {
+                i++;
+                continue;
+            }
+
+            size_t length = MIN_MATCH;
+            while (i + length < size - LAST_LITERALS && source[candidate + length] == source[i + length])
+            {
+                length++;
+            }
+            if (!writeSequence(out, end, source + anchor, i - anchor, i - candidate, length))
+            {
+                return 0;
+            }
+            i += length;
+            anchor = i;
+        }
+    }
+
+    if (!writeSequence(out, end, source + anchor, size - anchor, 0, 0))
+    {
+        return 0;
+    }
+    return static_cast<size_t>(out - start);
+}
+
+bool lz4Decompress(const char* source, size_t size, char* out, size_t rawSize)
+{
+    size_t in = 0, written = 0;
+    while (in < size)
+    {
+        unsigned char token = static_cast<unsigned char>(source[in++]);
+
+        size_t literalCount = token >> 4;
+        if (literalCount == 15)
+        {
+            unsigned char extra;
+            do
+            {
+                if (in >= size)
+                {
+                    return false;
+                }
+                extra = static_cast<unsigned char>(source[in++]);
+                literalCount += extra;
+            } while (extra == 255);
+        }
+        if (size - in < literalCount || rawSize - written < literalCount)
+        {
+            return false;
+        }
+        memcpy(out + written, source + in, literalCount);
+        in += literalCount;
+        written += literalCount;
+
+        if (in == size) //last sequence has no match
+        {
+            break;
+        }
+        if (size - in < 2)
+        {
+            return false;
+        }
+        size_t offset = static_cast<unsigned char>(source[in]) | (static_cast<size_t>(static_cast<unsigned char>(source[in + 1])) << 8);
+        in += 2;
+        if (offset == 0 || offset > written)
+        {
+            return false;
+        }
+
+        size_t length = token & 15;
+        if (length == 15)
+        {
+            unsigned char extra;
+            do
+            {
+                if (in >= size)
+                {
+                    return false;
+                }
+                extra = static_cast<unsigned char>(source[in++]);
+                length += extra;
+            } while (extra == 255);
+        }
+        length += MIN_MATCH;
+        if (rawSize - written < length)
+        {
+            return false;
+        }
+        for (size_t k = 0; k < length; k++, written++) //byte by byte, a match may overlap what it produces
+        {
+            out[written] = out[written - offset];
+        }
+    }
+    return written == rawSize;
+}
+
+bool ECE_MessageBatch::add(const tcpMessage& message)
+{
+    size_t used = body.size();
+    if (used + MAX_FRAME > BATCH_LIMIT)
+    {
+        return false;
+    }
+    body.resize(used + MAX_FRAME);
+    body.resize(used + encodeFrame(message, &body[used]));
+    messages++;
+    return true;
+}
+
+bool ECE_MessageBatch::addFrame(const char* frame, size_t size)
+{
+    if (body.size() + size > BATCH_LIMIT)
+    {
+        return false;
+    }
+    body.append(frame, size);
+    messages++;
+    return true;
+}
+
+void ECE_MessageBatch::finish(string& frame, bool compress) const
+{
+    size_t start = FRAME_HEADER + BATCH_HEADER;
+    frame.resize(start + body.size());
+
+    //compressed straight into the frame, kept only if it comes out smaller
+    size_t bodySize = compress ? lz4Compress(body.data(), body.size(), &frame[start], body.size()) : 0;
+    unsigned char flags = bodySize > 0 ? BATCH_COMPRESSED : 0;
+    if (bodySize == 0)
+    {
+        memcpy(&frame[start], body.data(), body.size());
+        bodySize = body.size();
+    }
+    frame.resize(start + bodySize);
+
+    putBigEndian(&frame[0], static_cast<uint32_t>(BATCH_HEADER + bodySize), 4);
+    frame[4] = static_cast<char>(MSG_VERSION_BATCH);
+    frame[5] = static_cast<char>(MSG_TYPE_BATCH);
+    frame[6] = static_cast<char>(flags);
+    frame[7] = 0;
+    putBigEndian(&frame[8], static_cast<uint32_t>(messages), 2);
+    putBigEndian(&frame[10], static_cast<uint32_t>(body.size()), 4);
+}
+
+void ECE_MessageBatch::clear()
+{
+    body.clear();
+    messages = 0;
+}
+
+size_t ECE_MessageBatch::count() const {return messages;}
+
+bool ECE_MessageBatch::empty() const {return messages == 0;}
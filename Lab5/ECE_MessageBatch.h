@@ -0,0 +1,103 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for batch frames, the protocol extension a client asks for with a HELLO message of
+version MSG_VERSION_BATCH. A batch frame carries several messages in one packet:
+    [packet size (4)][103 (1)][MSG_TYPE_BATCH (1)][flags (1)][0 (1)][count (2)][body size (4)][body]
+where the body is the messages' ordinary frames back to back, LZ4 block compressed when the
+BATCH_COMPRESSED flag is set. Numbers are big-endian like the rest of the protocol.
+
+*/
+
+#ifndef LAB5_ECE_MESSAGEBATCH_H
+#define LAB5_ECE_MESSAGEBATCH_H
+
+//directives
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "ECE_TcpMessage.h"
+
+const std::size_t BATCH_HEADER = 10; //batch fields after the packet size
+const std::size_t BATCH_LIMIT = 60000; //largest body before compression
+const std::size_t MAX_BATCH_FRAME = FRAME_HEADER + BATCH_HEADER + BATCH_LIMIT;
+const unsigned char BATCH_COMPRESSED = 1; //body is LZ4 compressed
+
+std::size_t lz4Compress(const char* source, std::size_t size, char* out, std::size_t capacity); //LZ4 block, 0 if it does not fit in capacity
+bool lz4Decompress(const char* source, std::size_t size, char* out, std::size_t rawSize); //false unless source expands to exactly rawSize bytes
+
+class ECE_MessageBatch //messages waiting to go out together in one batch frame
+{
+public:
+    bool add(const tcpMessage& message); //encodes the message straight into the batch, false if the batch is full
+    bool addFrame(const char* frame, std::size_t size); //adds a message that is already encoded as a frame
+    void finish(std::string& frame, bool compress) const; //writes the whole batch frame, compressed only if that makes it smaller
+    void clear();
+    [[nodiscard]] std::size_t count() const;
+    [[nodiscard]] bool empty() const;
+
+private:
+    std::string body; //frames back to back
+    std::size_t messages = 0;
+};
+
+inline bool isBatch(const char* payload, std::size_t size) //true if a frame's payload (after the size field) is a batch
+{
+    return size >= BATCH_HEADER && static_cast<unsigned char>(payload[0]) == MSG_VERSION_BATCH &&
+           static_cast<unsigned char>(payload[1]) == MSG_TYPE_BATCH;
+}
+
+//calls handle(tcpMessage&) for every message of a batch payload, in order; scratch only holds the
+//body of a compressed batch, an uncompressed one is read where it lies. False if the batch is malformed
+template <typename Handler>
+bool forEachInBatch(const char* payload, std::size_t size, std::string& scratch, Handler handle)
+{
+    if (!isBatch(payload, size))
+    {
+        return false;
+    }
+    std::size_t count = getBigEndian(payload + 4, 2);
+    std::size_t bodySize = getBigEndian(payload + 6, 4);
+    if (bodySize > BATCH_LIMIT)
+    {
+        return false;
+    }
+
+    const char* body = payload + BATCH_HEADER;
+    if (payload[2] & BATCH_COMPRESSED)
+    {
+        scratch.resize(bodySize);
+        if (!lz4Decompress(body, size - BATCH_HEADER, &scratch[0], bodySize))
+        {
+            return false;
+        }
+        body = scratch.data();
+    }
+    else if (bodySize != size - BATCH_HEADER)
+    {
+        return false;
+    }
+
+    tcpMessage message;
+    std::size_t used = 0;
+    for (std::size_t m = 0; m < count; m++)
+    {
+        if (bodySize - used < FRAME_HEADER)
+        {
+            return false;
+        }
+        std::size_t length = getBigEndian(body + used, FRAME_HEADER);
+        if (bodySize - used - FRAME_HEADER < length || !decodePayload(body + used + FRAME_HEADER, length, message))
+        {
+            return false;
+        }
+        used += FRAME_HEADER + length;
+        handle(message);
+    }
+    return used == bodySize;
+}
+
+#endif
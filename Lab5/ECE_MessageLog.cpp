@@ -0,0 +1,360 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Message log source file. Each record is stored as the frame encodeFrame produces, which is the
+same framing SFML uses for a packet sent over a TcpSocket, with a CRC-32 of the record appended
+and counted in the frame's size. Readers stop after nRecord, so the checksum never reaches them.
+
+*/
+
+//directives
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
+#include <arpa/inet.h>
+#include "ECE_MessageLog.h"
+
+using namespace std;
+
+const size_t RECORD_CHECK = 4; //CRC-32 trailing every record
+
+static uint32_t crc32(const char* data, size_t size) //reflected CRC-32 (polynomial 0xEDB88320), as zlib computes it
+{
+    static uint32_t table[256];
+    static bool ready = false;
+    if (!ready) //first use happens in the constructor, before the flusher thread exists
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++)
+            {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        ready = true;
+    }
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static bool syncRange(char* map, size_t from, size_t to) //msyncs bytes [from, to) of a segment mapping
+{
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    from -= from % page; //msync needs a page aligned address
+    if (to > from && msync(map + from, to - from, MS_SYNC) != 0)
+    {
+        perror("msync");
+        return false;
+    }
+    return true;
+}
+
+static string segmentPath(const string& dir, size_t index) //file name of a segment
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/segment_%06zu.log", index);
+    return dir + name;
+}
+
+ECE_MessageLog::ECE_MessageLog(const string& dir, size_t segmentSize, size_t commitBatch, chrono::milliseconds commitWindow)
+    : dir(dir), segmentSize(segmentSize), commitBatch(commitBatch), commitWindow(commitWindow)
+{
+    mkdir(dir.c_str(), 0755); //fine if it already exists
+
+    struct stat info;
+    for (size_t i = 0; stat(segmentPath(dir, i).c_str(), &info) == 0; i++) //recovering segments left by an earlier run
+    {
+        openSegment(i, false);
+    }
+    if (segments.empty())
+    {
+        openSegment(0, true);
+    }
+
+    mapActive();
+    crc32(nullptr, 0); //builds the table before a second thread can race to it
+    committedRecords = recordPos.size(); //everything recovered is already on disk
+
+    flusher = thread(&ECE_MessageLog::flushLoop, this);
+}
+
+ECE_MessageLog::~ECE_MessageLog()
+{
+    {
+        lock_guard<mutex> lock(logMutex);
+        stopping = true;
+    }
+    wakeFlusher.notify_all();
+    flusher.join();
+
+    unique_lock<mutex> lock(logMutex);
+    commitPending(lock);
+    Segment& last = segments.back();
+    munmap(active, segmentSize);
+    if (ftruncate(last.fd, last.used) != 0) //trimming the unused tail of the last segment
+    {
+        perror("ftruncate");
+    }
+    for (auto& segment : segments)
+    {
+        close(segment.fd);
+    }
+}
+
+void ECE_MessageLog::openSegment(size_t index, bool create)
+{
+    string path = segmentPath(dir, index);
+    int fd = open(path.c_str(), O_RDWR | (create ? O_CREAT | O_TRUNC : 0), 0644);
+    if (fd < 0)
+    {
+        perror(path.c_str());
+        exit(1);
+    }
+
+    Segment segment = {fd, 0, recordPos.size()};
+
+    if (!create) //scanning records until the zero padding or the first one whose checksum fails
+    {
+        struct stat info;
+        fstat(fd, &info);
+        size_t fileSize = static_cast<size_t>(info.st_size);
+        vector<char> record;
+        uint32_t size;
+        while (segment.used + sizeof(size) <= fileSize && pread(fd, &size, sizeof(size), segment.used) == sizeof(size))
+        {
+            size = ntohl(size);
+            if (size < RECORD_CHECK || size > MAX_FRAME || segment.used + sizeof(size) + size > fileSize)
+            {
+                break;
+            }
+            record.resize(FRAME_HEADER + size);
+            if (pread(fd, record.data(), record.size(), segment.used) != static_cast<ssize_t>(record.size()) ||
+                crc32(record.data(), record.size() - RECORD_CHECK) != getBigEndian(record.data() + record.size() - RECORD_CHECK, 4)) //torn write
+            {
+                break;
+            }
+            recordPos.push_back(segment.used);
+            segment.used += record.size();
+        }
+    }
+
+    segments.push_back(segment);
+}
+
+void ECE_MessageLog::mapActive()
+{
+    Segment& last = segments.back();
+    if (ftruncate(last.fd, segmentSize) != 0) //preallocating so appends never change the file size, the size reaches disk with the first msync
+    {
+        perror("ftruncate");
+        exit(1);
+    }
+
+    void* map = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, last.fd, 0);
+    if (map == MAP_FAILED)
+    {
+        perror("mmap");
+        exit(1);
+    }
+    active = static_cast<char*>(map);
+    dirtyFrom = last.used;
+}
+
+uint64_t ECE_MessageLog::append(tcpMessage& message)
+{
+    unique_lock<mutex> lock(logMutex);
+
+    uint64_t offset = recordPos.size();
+    message.nRecord = offset; //stored with the record, so replayed and live copies both tell the client where it is
+    size_t size = frameSize(message) + RECORD_CHECK;
+
+    bool rolled = false;
+    if (segments.back().used + size > segmentSize) //rolling over to a new segment, the flusher seals the old one
+    {
+        Segment& full = segments.back();
+        retired.push_back({full.fd, active, dirtyFrom, full.used});
+        openSegment(segments.size(), true);
+        mapActive();
+        rolled = true;
+    }
+
+    Segment& last = segments.back();
+    char* record = active + last.used;
+    encodeFrame(message, record);
+    putBigEndian(record, static_cast<uint32_t>(size - FRAME_HEADER), 4); //the frame's size covers the checksum
+    putBigEndian(record + size - RECORD_CHECK, crc32(record, size - RECORD_CHECK), 4);
+
+    recordPos.push_back(last.used);
+    last.used += size;
+
+    if (++pendingRecords >= commitBatch || rolled) //a full batch or a full segment is committed right away
+    {
+        lock.unlock();
+        wakeFlusher.notify_one();
+    }
+    return offset;
+}
+
+void ECE_MessageLog::commitPending(unique_lock<mutex>& lock)
+{
+    commitDone.wait(lock, [this] { return !committing; }); //one commit at a time, so they publish in order
+    if (pendingRecords == 0 && retired.empty())
+    {
+        return;
+    }
+
+    //only a snapshot is taken under the lock; appends carry on into the same mapping while the disk works,
+    //and a rollover meanwhile leaves this mapping in retired for the next commit to unmap
+    vector<Retired> sealing;
+    sealing.swap(retired);
+    char* map = active;
+    size_t from = dirtyFrom;
+    size_t used = segments.back().used;
+    uint64_t records = recordPos.size();
+    committing = true;
+    lock.unlock();
+
+    bool synced = true;
+    for (auto& segment : sealing) //older records first, so committed never counts past a gap
+    {
+        synced = syncRange(segment.map, segment.dirtyFrom, segment.used) && synced;
+        munmap(segment.map, segmentSize);
+        if (ftruncate(segment.fd, segment.used) != 0 || fsync(segment.fd) != 0) //sealed segments hold only whole records
+        {
+            perror("ftruncate");
+            synced = false;
+        }
+    }
+    synced = synced && syncRange(map, from, used);
+
+    lock.lock();
+    committing = false;
+    if (synced)
+    {
+        if (map == active) //still the active segment, later appends stay dirty
+        {
+            dirtyFrom = used;
+        }
+        committedRecords = records;
+        pendingRecords = recordPos.size() - records;
+    }
+    commitDone.notify_all();
+}
+
+void ECE_MessageLog::flush()
+{
+    unique_lock<mutex> lock(logMutex);
+    commitPending(lock);
+}
+
+void ECE_MessageLog::flushLoop()
+{
+    unique_lock<mutex> lock(logMutex);
+    while (!stopping)
+    {
+        //one msync covers every message appended during the window
+        wakeFlusher.wait_for(lock, commitWindow, [this] { return stopping || pendingRecords >= commitBatch || !retired.empty(); });
+        commitPending(lock);
+    }
+}
+
+bool ECE_MessageLog::startReplay(uint64_t fromOffset, ReplayCursor& cursor) const
+{
+    lock_guard<mutex> lock(logMutex);
+    //every appended record, durable or not: the bytes are in the page cache either way, and one appended
+    //before the client connected but not yet committed would otherwise reach it neither live nor replayed
+    uint64_t end = recordPos.size();
+    cursor.end = end;
+    if (fromOffset >= end)
+    {
+        cursor.segment = cursor.lastSegment = 0;
+        cursor.from = cursor.to = 0;
+        return false;
+    }
+
+    //segments holding the first record to send and the end of the last one
+    auto first = upper_bound(segments.begin(), segments.end(), fromOffset,
+                             [](uint64_t offset, const Segment& segment) { return offset < segment.firstRecord; });
+    cursor.segment = static_cast<size_t>(first - segments.begin()) - 1;
+    cursor.from = static_cast<off_t>(recordPos[fromOffset]);
+    cursor.lastSegment = segments.size() - 1;
+    cursor.to = static_cast<off_t>(segments.back().used);
+    return true;
+}
+
+long long ECE_MessageLog::continueReplay(int socketFd, ReplayCursor& cursor, size_t maxBytes) const
+{
+    //sendfile has no flag for a single non-blocking call, so the socket is switched over just for it
+    int flags = fcntl(socketFd, F_GETFL);
+    if (flags < 0 || (!(flags & O_NONBLOCK) && fcntl(socketFd, F_SETFL, flags | O_NONBLOCK) < 0))
+    {
+        return -1;
+    }
+
+    long long sent = 0;
+    while (!cursor.done() && static_cast<size_t>(sent) < maxBytes) //the kernel copies straight from the page cache to the socket
+    {
+        int fd;
+        off_t to;
+        {
+            lock_guard<mutex> lock(logMutex);
+            fd = segments[cursor.segment].fd;
+            to = cursor.segment == cursor.lastSegment ? cursor.to : static_cast<off_t>(segments[cursor.segment].used); //earlier segments are sealed
+        }
+        if (cursor.from >= to) //rest of the replay is in the next segment
+        {
+            cursor.segment++;
+            cursor.from = 0;
+            continue;
+        }
+
+        ssize_t n = sendfile(socketFd, fd, &cursor.from, min(static_cast<size_t>(to - cursor.from), maxBytes - static_cast<size_t>(sent)));
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN) //socket is full when it is EAGAIN, the caller comes back later
+        {
+            sent = -1;
+        }
+        if (n <= 0)
+        {
+            break;
+        }
+        sent += n;
+    }
+
+    if (!(flags & O_NONBLOCK))
+    {
+        fcntl(socketFd, F_SETFL, flags);
+    }
+    return sent;
+}
+
+uint64_t ECE_MessageLog::size() const
+{
+    lock_guard<mutex> lock(logMutex);
+    return recordPos.size();
+}
+
+uint64_t ECE_MessageLog::committed() const
+{
+    lock_guard<mutex> lock(logMutex);
+    return committedRecords;
+}
@@ -0,0 +1,97 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for the append-only message log. Messages are written into memory-mapped
+segment files already framed exactly like an sf::Packet on the wire, so a replay can
+hand the file straight to the socket with sendfile instead of copying it through the server.
+Each record ends in a CRC-32 inside its frame, after the fields a reader decodes, so recovery
+can tell a torn record from a whole one. Disk flushes run on a background thread without the
+log's lock, so appends from the event loop never wait on the disk.
+
+*/
+
+#ifndef LAB5_ECE_MESSAGELOG_H
+#define LAB5_ECE_MESSAGELOG_H
+
+//directives
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+#include <sys/types.h>
+#include "ECE_TcpMessage.h"
+
+struct ReplayCursor //how far a replay has got, so it can carry on in a later loop pass
+{
+    uint64_t end = 0; //one past the last record replayed
+    std::size_t segment = 0; //segment being sent and its next byte
+    off_t from = 0;
+    std::size_t lastSegment = 0; //segment and byte the replay stops at
+    off_t to = 0;
+
+    [[nodiscard]] bool done() const {return segment == lastSegment && from >= to;}
+};
+
+class ECE_MessageLog //persistent log of broadcast messages with group-committed fsyncs
+{
+public:
+    ECE_MessageLog(const std::string& dir, std::size_t segmentSize = 16 << 20, std::size_t commitBatch = 64,
+                   std::chrono::milliseconds commitWindow = std::chrono::milliseconds(5)); //opens or recovers the log in dir
+    ~ECE_MessageLog(); //commits anything pending and closes all segments
+
+    uint64_t append(tcpMessage& message); //stamps message with its offset (record number) in the log, appends it and returns the offset
+    void flush(); //forces every appended message to disk before returning
+    bool startReplay(uint64_t fromOffset, ReplayCursor& cursor) const; //points cursor at the records from fromOffset to the current end, false if there are none
+    long long continueReplay(int socketFd, ReplayCursor& cursor, std::size_t maxBytes) const; //sends at most maxBytes without blocking, returns bytes sent or -1
+    [[nodiscard]] uint64_t size() const; //number of records in the log
+    [[nodiscard]] uint64_t committed() const; //number of records known to be on disk
+
+private:
+    struct Segment //one segment file of the log
+    {
+        int fd;
+        std::size_t used; //bytes of records written into the segment
+        uint64_t firstRecord; //offset of the first record stored in the segment
+    };
+
+    struct Retired //full segment left for the flusher to sync, unmap and trim
+    {
+        int fd;
+        char* map;
+        std::size_t dirtyFrom;
+        std::size_t used;
+    };
+
+    void openSegment(std::size_t index, bool create); //opens a segment file and scans its valid records
+    void mapActive(); //maps the last segment so appends can write into it
+    void commitPending(std::unique_lock<std::mutex>& lock); //syncs everything appended so far, dropping lock while the disk works
+    void flushLoop(); //background thread batching commits
+
+    std::string dir;
+    std::size_t segmentSize;
+    std::size_t commitBatch;
+    std::chrono::milliseconds commitWindow;
+
+    std::vector<Segment> segments;
+    std::vector<std::size_t> recordPos; //byte position of each record inside its segment
+    char* active = nullptr; //mapping of the last segment
+    std::size_t dirtyFrom = 0; //first byte of the active segment not yet synced
+    uint64_t committedRecords = 0;
+    uint64_t pendingRecords = 0;
+    std::vector<Retired> retired; //segments rolled over since the last commit
+    bool committing = false; //a commit is flushing outside the lock
+    std::condition_variable commitDone;
+
+    mutable std::mutex logMutex;
+    std::condition_variable wakeFlusher;
+    bool stopping = false;
+    std::thread flusher;
+};
+
+#endif
@@ -0,0 +1,66 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for the server's networking backends. A backend owns the sockets and the event loop,
+decodes each message a client sends (every message of a batch frame in turn) and passes it to the shared handler, which answers through
+the backend's send, broadcast, replay and close functions. That keeps the message handling for
+every type identical whichever backend is running.
+
+*/
+
+#ifndef LAB5_ECE_SERVERBACKEND_H
+#define LAB5_ECE_SERVERBACKEND_H
+
+//directives
+#include <cstdint>
+#include <cstdio>
+#include <chrono>
+#include "ECE_TcpMessage.h"
+#include "ECE_ConnectionTable.h"
+
+//timer wheel settings shared by the backends, one tick every 100 ms
+const uint64_t TICK_MS = 100;
+const uint64_t HEARTBEAT_TICKS = 150; //15 s of silence before a heartbeat is sent
+const uint64_t IDLE_TICKS = 300; //30 s of silence before the connection is dropped
+
+inline uint64_t currentTick() //current timer wheel tick
+{
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now).count()) / TICK_MS;
+}
+
+class ECE_ServerBackend //event loop and sockets of the server
+{
+public:
+    virtual ~ECE_ServerBackend() = default;
+
+    virtual bool listen(unsigned short port) = 0; //false if the port cannot be opened
+    virtual void run() = 0; //event loop, never returns
+
+    //called by the message handler from inside run()
+    virtual void send(ConnectionId id, const tcpMessage& message) = 0; //to one client
+    virtual void broadcast(ConnectionId sender, const tcpMessage& message) = 0; //to every client except sender
+    virtual void replay(ConnectionId id, uint64_t offset) = 0; //streams the message log from offset to one client, then replayDoneMessage
+    virtual void close(ConnectionId id) = 0; //drops one client
+    virtual void setFeatures(ConnectionId id, unsigned short features) = 0; //protocol extensions agreed with the client, FEATURE_ bits
+
+    //called from the console thread
+    virtual void printClients() = 0; //lists connected clients
+    virtual void requestExit(const tcpMessage& exitMessage) = 0; //sends exitMessage to every client, then exits the program
+};
+
+const std::size_t REPLAY_SLICE = 256 << 10; //bytes of history a replaying client is sent before the loop moves on
+
+inline tcpMessage replayDoneMessage(uint64_t end) //tells a client the log offset a replay brought it up to, kept for its next reconnect
+{
+    tcpMessage done = {MSG_VERSION, MSG_TYPE_REPLAY, 1, ""};
+    snprintf(done.chMsg, sizeof(done.chMsg), "%llu", static_cast<unsigned long long>(end));
+    return done;
+}
+
+typedef void (*MessageHandler)(ECE_ServerBackend& backend, ConnectionId id, tcpMessage& message); //handles one decoded message
+
+#endif
@@ -0,0 +1,117 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for the message structure shared by the Lab5 client and server.
+
+*/
+
+#ifndef LAB5_ECE_TCPMESSAGE_H
+#define LAB5_ECE_TCPMESSAGE_H
+
+//directives
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+const uint64_t NO_RECORD = UINT64_MAX; //message is not a record of the log
+
+struct tcpMessage //Data using following packet structure
+{
+    unsigned char nVersion;
+    unsigned char nType;
+    unsigned short nMsgLen;
+    char chMsg[1000];
+    uint64_t nRecord = NO_RECORD; //log offset of a logged broadcast, sent after chMsg so clients that do not read it are unaffected
+};
+
+//message types understood by the server
+const unsigned char MSG_TYPE_CLOSE = 1; //client is closing the connection
+const unsigned char MSG_TYPE_REPLAY = 2; //chMsg holds the log offset to replay history from; from the server, the offset a finished replay reached
+const unsigned char MSG_TYPE_HEARTBEAT = 3; //server checking an idle client, echoed back by the client
+const unsigned char MSG_TYPE_HELLO = 4; //protocol negotiation, nMsgLen holds the FEATURE_ bits asked for or agreed to
+const unsigned char MSG_TYPE_BATCH = 5; //several messages in one frame, see ECE_MessageBatch.h
+const unsigned char MSG_TYPE_BROADCAST = 77; //forwarded to every other client
+const unsigned char MSG_TYPE_REVERSE = 201; //reversed and sent back to the sender
+
+const unsigned char MSG_VERSION = 102; //version of ordinary messages
+const unsigned char MSG_VERSION_BATCH = 103; //version of HELLO and BATCH frames, a server that only knows 102 ignores them
+
+//protocol extensions agreed with a HELLO
+const unsigned short FEATURE_BATCH = 1; //batch frames in both directions
+const unsigned short FEATURE_COMPRESS = 2; //batch bodies may be compressed
+
+//a message framed the way sf::Packet sends it over TCP, all fields big-endian:
+//[packet size (4)][nVersion (1)][nType (1)][nMsgLen (2)][string length (4)][chMsg][nRecord (8), only if set]
+const std::size_t FRAME_HEADER = 4; //packet size field
+const std::size_t MAX_FRAME = FRAME_HEADER + 1 + 1 + 2 + 4 + sizeof(tcpMessage::chMsg) + 8;
+
+inline std::size_t frameSize(const tcpMessage& message) //bytes encodeFrame writes for message
+{
+    return FRAME_HEADER + 1 + 1 + 2 + 4 + strnlen(message.chMsg, sizeof(message.chMsg)) + (message.nRecord != NO_RECORD ? 8 : 0);
+}
+
+//big-endian fields, done by hand so this header does not pull in the socket headers (the client has a global named socket)
+inline void putBigEndian(char* out, uint32_t value, int bytes)
+{
+    for (int b = bytes - 1; b >= 0; b--, value >>= 8)
+    {
+        out[b] = static_cast<char>(value & 0xFF);
+    }
+}
+
+inline uint32_t getBigEndian(const char* in, int bytes)
+{
+    uint32_t value = 0;
+    for (int b = 0; b < bytes; b++)
+    {
+        value = (value << 8) | static_cast<unsigned char>(in[b]);
+    }
+    return value;
+}
+
+inline std::size_t encodeFrame(const tcpMessage& message, char* out) //writes the frame to out (at least MAX_FRAME bytes), returns its size
+{
+    uint32_t length = static_cast<uint32_t>(strnlen(message.chMsg, sizeof(message.chMsg)));
+    std::size_t size = frameSize(message);
+    putBigEndian(out, static_cast<uint32_t>(size - FRAME_HEADER), 4);
+    out[4] = static_cast<char>(message.nVersion);
+    out[5] = static_cast<char>(message.nType);
+    putBigEndian(out + 6, message.nMsgLen, 2);
+    putBigEndian(out + 8, length, 4);
+    memcpy(out + 12, message.chMsg, length);
+    if (message.nRecord != NO_RECORD) //same layout as an sf::Uint64 in a packet
+    {
+        putBigEndian(out + 12 + length, static_cast<uint32_t>(message.nRecord >> 32), 4);
+        putBigEndian(out + 16 + length, static_cast<uint32_t>(message.nRecord), 4);
+    }
+    return size;
+}
+
+inline bool decodePayload(const char* payload, std::size_t size, tcpMessage& message) //parses a frame's payload (after the size field), false if malformed
+{
+    if (size < 8)
+    {
+        return false;
+    }
+    uint32_t length = getBigEndian(payload + 4, 4);
+    if (length >= sizeof(message.chMsg) || size < 8 + length)
+    {
+        return false;
+    }
+    message.nVersion = static_cast<unsigned char>(payload[0]);
+    message.nType = static_cast<unsigned char>(payload[1]);
+    message.nMsgLen = static_cast<unsigned short>(getBigEndian(payload + 2, 2));
+    memcpy(message.chMsg, payload + 8, length);
+    message.chMsg[length] = '\0';
+    message.nRecord = NO_RECORD;
+    if (size - 8 - length >= 8)
+    {
+        message.nRecord = (static_cast<uint64_t>(getBigEndian(payload + 8 + length, 4)) << 32) | getBigEndian(payload + 12 + length, 4);
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,119 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Timer wheel source file. Each deadline is hashed into bucket (expiry % wheel size), so timers further
+out than one turn of the wheel just stay in their bucket until their tick comes round.
+
+*/
+
+//directives
+#include "ECE_TimerWheel.h"
+
+using namespace std;
+
+ECE_TimerWheel::ECE_TimerWheel(uint64_t heartbeatTicks, uint64_t idleTicks, size_t wheelSize)
+    : heartbeatTicks(heartbeatTicks), idleTicks(idleTicks), wheel(wheelSize, NO_KEY) {}
+
+void ECE_TimerWheel::start(uint32_t key, uint64_t now)
+{
+    if (key >= timers.size())
+    {
+        timers.resize(static_cast<size_t>(key) + 1);
+    }
+    if (timers[key].running) //a key reused without a stop starts over
+    {
+        unschedule(key);
+    }
+    timers[key].running = true;
+    timers[key].heartbeatSent = false;
+    schedule(key, now + heartbeatTicks);
+}
+
+void ECE_TimerWheel::stop(uint32_t key)
+{
+    if (key >= timers.size() || !timers[key].running)
+    {
+        return;
+    }
+    unschedule(key);
+    timers[key].running = false;
+}
+
+void ECE_TimerWheel::touch(uint32_t key, uint64_t now)
+{
+    if (key >= timers.size() || !timers[key].running)
+    {
+        return;
+    }
+    timers[key].heartbeatSent = false;
+    unschedule(key);
+    schedule(key, now + heartbeatTicks);
+}
+
+void ECE_TimerWheel::schedule(uint32_t key, uint64_t expiry)
+{
+    Timer& timer = timers[key];
+    uint32_t& head = wheel[expiry % wheel.size()];
+    timer.expiry = expiry;
+    timer.prev = NO_KEY;
+    timer.next = head;
+    if (head != NO_KEY)
+    {
+        timers[head].prev = key;
+    }
+    head = key;
+}
+
+void ECE_TimerWheel::unschedule(uint32_t key)
+{
+    Timer& timer = timers[key];
+    if (timer.prev != NO_KEY)
+    {
+        timers[timer.prev].next = timer.next;
+    }
+    else
+    {
+        wheel[timer.expiry % wheel.size()] = timer.next;
+    }
+    if (timer.next != NO_KEY)
+    {
+        timers[timer.next].prev = timer.prev;
+    }
+    timer.prev = NO_KEY;
+    timer.next = NO_KEY;
+}
+
+void ECE_TimerWheel::advance(uint64_t now, vector<TimerEvent>& events)
+{
+    //after a long stall one full turn already visits every bucket
+    uint64_t from = (now - lastTick > wheel.size()) ? now - wheel.size() + 1 : lastTick + 1;
+    for (uint64_t tick = from; tick <= now; tick++)
+    {
+        uint32_t key = wheel[tick % wheel.size()];
+        while (key != NO_KEY)
+        {
+            Timer& timer = timers[key];
+            uint32_t nextKey = timer.next;
+            if (timer.expiry <= now) //timers for a later turn of the wheel stay put
+            {
+                unschedule(key);
+                if (timer.heartbeatSent) //no answer since the heartbeat went out
+                {
+                    events.push_back({key, true});
+                    schedule(key, now + idleTicks); //kept scheduled until the caller stops it
+                }
+                else
+                {
+                    timer.heartbeatSent = true;
+                    events.push_back({key, false});
+                    schedule(key, now + idleTicks - heartbeatTicks);
+                }
+            }
+            key = nextKey;
+        }
+    }
+    lastTick = now;
+}
@@ -0,0 +1,59 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for the hashed timer wheel that drives heartbeats and idle timeouts. Timers are named
+by a key the caller picks (a connection table slot, a file descriptor), so every backend can put
+its connections on a wheel without the wheel knowing how they are stored.
+
+*/
+
+#ifndef LAB5_ECE_TIMERWHEEL_H
+#define LAB5_ECE_TIMERWHEEL_H
+
+//directives
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct TimerEvent //what the timer wheel wants done with a connection
+{
+    uint32_t key;
+    bool idle; //true if the connection timed out, false if it is due a heartbeat
+};
+
+class ECE_TimerWheel //one heartbeat/idle timer per key with O(1) start, stop and touch
+{
+public:
+    ECE_TimerWheel(uint64_t heartbeatTicks, uint64_t idleTicks, std::size_t wheelSize = 256); //timeouts are in ticks
+
+    void start(uint32_t key, uint64_t now); //schedules the key's first heartbeat, keys should be small and dense
+    void stop(uint32_t key); //cancels the key's timer, nothing fires for it until it is started again
+    void touch(uint32_t key, uint64_t now); //activity restarts a running timer's heartbeat countdown
+    void advance(uint64_t now, std::vector<TimerEvent>& events); //fires every timer due up to now
+
+private:
+    static constexpr uint32_t NO_KEY = 0xFFFFFFFF; //end of a bucket
+
+    struct Timer //intrusive bucket links, so stopping never searches
+    {
+        bool running = false;
+        bool heartbeatSent = false; //waiting for the client to answer a heartbeat
+        uint64_t expiry = 0; //tick the timer fires on
+        uint32_t prev = NO_KEY;
+        uint32_t next = NO_KEY;
+    };
+
+    void schedule(uint32_t key, uint64_t expiry); //links a key into its bucket
+    void unschedule(uint32_t key); //unlinks a key from its bucket
+
+    uint64_t heartbeatTicks;
+    uint64_t idleTicks;
+    std::vector<Timer> timers; //indexed by key
+    std::vector<uint32_t> wheel; //head key of each bucket
+    uint64_t lastTick = 0; //last tick the wheel was advanced to
+};
+
+#endif
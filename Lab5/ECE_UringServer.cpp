@@ -0,0 +1,786 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+io_uring backend source file. Every submission carries its operation, file descriptor and the
+client's generation in user_data, so a completion that arrives after its client was closed (and
+the descriptor reused) is recognised and only its receive buffer is given back.
+
+*/
+
+//directives
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <cstdlib>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <arpa/inet.h>
+#include "ECE_UringServer.h"
+
+using namespace std;
+
+ECE_UringServer::ECE_UringServer(MessageHandler handler, ECE_MessageLog& log, unsigned entries, unsigned bufferCount,
+                                 unsigned bufferSize)
+    : handler(handler), log(log), bufferCount(bufferCount), bufferSize(bufferSize)
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ringFd < 0)
+    {
+        perror("io_uring_setup");
+        exit(1);
+    }
+
+    //mapping the queues, older kernels map the completion ring separately
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap)
+    {
+        sqRingSize = cqRingSize = max(sqRingSize, cqRingSize);
+    }
+    sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    cqRing = singleMap ? sqRing : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqeMap = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || sqeMap == MAP_FAILED)
+    {
+        perror("mmap");
+        exit(1);
+    }
+    sqes = static_cast<io_uring_sqe*>(sqeMap);
+
+    char* sq = static_cast<char*>(sqRing);
+    char* cq = static_cast<char*>(cqRing);
+    sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    sqEntries = params.sq_entries;
+    cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    localTail = submitted = *sqTail;
+
+    //receive buffers the kernel picks from, through the buffer ring or handed over with the first submission on older kernels
+    buffers = new char[static_cast<size_t>(bufferCount) * bufferSize];
+    if (!registerBufferRing())
+    {
+        provideBuffers(0, bufferCount);
+    }
+
+    tick.tv_sec = 0;
+    tick.tv_nsec = 10 * 1000 * 1000; //same 10 ms the selector waits in the SFML backend
+}
+
+ECE_UringServer::~ECE_UringServer()
+{
+    for (size_t fd = 0; fd < connections.size(); fd++)
+    {
+        if (connections[fd].open)
+        {
+            ::close(static_cast<int>(fd));
+        }
+    }
+    if (listenFd >= 0)
+    {
+        ::close(listenFd);
+    }
+    ::close(ringFd); //kernel is done with the buffers once the ring is gone
+    delete[] buffers;
+    if (bufferRing != nullptr)
+    {
+        munmap(bufferRing, bufferRingSize);
+    }
+    munmap(sqes, sqesSize);
+    if (cqRing != sqRing)
+    {
+        munmap(cqRing, cqRingSize);
+    }
+    munmap(sqRing, sqRingSize);
+}
+
+bool ECE_UringServer::listen(unsigned short port)
+{
+    listenFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0)
+    {
+        perror("socket");
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(listenFd, SOMAXCONN) < 0)
+    {
+        perror("bind");
+        return false;
+    }
+    return true;
+}
+
+uint64_t ECE_UringServer::encodeData(Operation op, int fd, uint32_t generation)
+{
+    return (static_cast<uint64_t>(op) << 56) | (static_cast<uint64_t>(fd & 0xFFFFFF) << 32) | generation;
+}
+
+io_uring_sqe* ECE_UringServer::nextSqe()
+{
+    if (localTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) //queue full, hand it to the kernel first
+    {
+        enter(0);
+    }
+    unsigned index = localTail & *sqMask;
+    io_uring_sqe* sqe = &sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqArray[index] = index;
+    localTail++;
+    return sqe;
+}
+
+void ECE_UringServer::enter(unsigned waitFor)
+{
+    __atomic_store_n(sqTail, localTail, __ATOMIC_RELEASE);
+    unsigned flags = waitFor > 0 ? IORING_ENTER_GETEVENTS : 0;
+    long taken = syscall(__NR_io_uring_enter, ringFd, localTail - submitted, waitFor, flags, nullptr, 0);
+    if (taken < 0)
+    {
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY) //completions are drained and the call retried next pass
+        {
+            return;
+        }
+        perror("io_uring_enter");
+        exit(1);
+    }
+    submitted += static_cast<unsigned>(taken);
+}
+
+void ECE_UringServer::armAccept()
+{
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listenFd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT; //one submission keeps accepting
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = encodeData(OP_ACCEPT, listenFd, 0);
+}
+
+void ECE_UringServer::armRecv(int fd)
+{
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT; //one submission keeps receiving
+    sqe->flags = IOSQE_BUFFER_SELECT; //kernel picks a buffer from group 0
+    sqe->buf_group = 0;
+    sqe->user_data = encodeData(OP_RECV, fd, connections[fd].generation);
+}
+
+void ECE_UringServer::armTimeout()
+{
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(&tick);
+    sqe->len = 1;
+    sqe->user_data = encodeData(OP_TIMEOUT, 0, 0);
+}
+
+void ECE_UringServer::armSend(int fd)
+{
+    UringConnection& connection = connections[fd];
+
+    //a replay runs once everything queued before it is out, so the client sees messages in order; it goes
+    //a slice at a time and carries on when the kernel reports room, so one client's history never stalls the loop
+    if (!connection.outbox.empty() && !connection.outbox.front().frame)
+    {
+        Outgoing& item = connection.outbox.front();
+        if (!item.started) //nothing to replay leaves the cursor done
+        {
+            log.startReplay(item.replayFrom, item.replay);
+            item.started = true;
+        }
+        long long sent = item.replay.done() ? 0 : log.continueReplay(fd, item.replay, REPLAY_SLICE);
+        if (sent < 0)
+        {
+            cout << "Replay to port " << ntohs(connection.peer.sin_port) << " failed." << endl;
+            close({static_cast<uint32_t>(fd), connection.generation});
+            return;
+        }
+        if (sent > 0) //the client is reading, which is as good as a heartbeat
+        {
+            timers.touch(static_cast<uint32_t>(fd), currentTick());
+        }
+        if (!item.replay.done())
+        {
+            armWritable(fd);
+            return;
+        }
+        auto frame = make_shared<string>(MAX_FRAME, '\0'); //the entry becomes the message ending the replay
+        frame->resize(encodeFrame(replayDoneMessage(item.replay.end), &(*frame)[0]));
+        item.frame = frame;
+    }
+    if (connection.outbox.empty()) //everything before the batch is out, so the batch goes next
+    {
+        if (connection.pending.empty())
+        {
+            return;
+        }
+        sealBatch(connection);
+    }
+
+    const Frame& frame = connection.outbox.front().frame;
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(frame->data() + connection.sentOfFront);
+    sqe->len = static_cast<uint32_t>(frame->size() - connection.sentOfFront);
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = encodeData(OP_SEND, fd, connection.generation);
+    inFlight[sqe->user_data] = frame; //kept alive until the kernel has read it, even if the client closes
+    connection.sending = true;
+}
+
+void ECE_UringServer::armWritable(int fd)
+{
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = POLLOUT;
+    sqe->user_data = encodeData(OP_WRITABLE, fd, connections[fd].generation);
+    connections[fd].sending = true; //nothing else goes out until the replay has continued
+}
+
+bool ECE_UringServer::registerBufferRing()
+{
+    if (bufferCount == 0 || bufferCount > 32768 || (bufferCount & (bufferCount - 1)) != 0) //ring size must be a power of two
+    {
+        return false;
+    }
+    bufferRingSize = static_cast<size_t>(bufferCount) * sizeof(io_uring_buf);
+    void* ring = mmap(nullptr, bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0); //page aligned
+    if (ring == MAP_FAILED)
+    {
+        return false;
+    }
+    io_uring_buf_reg registration;
+    memset(&registration, 0, sizeof(registration));
+    registration.ring_addr = reinterpret_cast<uint64_t>(ring);
+    registration.ring_entries = bufferCount;
+    registration.bgid = 0;
+    if (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0) //kernels before 5.19
+    {
+        munmap(ring, bufferRingSize);
+        return false;
+    }
+    bufferRing = static_cast<io_uring_buf_ring*>(ring);
+    ringTail = 0;
+    for (unsigned id = 0; id < bufferCount; id++)
+    {
+        returnBuffer(static_cast<unsigned short>(id));
+    }
+    return true;
+}
+
+void ECE_UringServer::returnBuffer(unsigned short bufferId)
+{
+    if (bufferRing == nullptr)
+    {
+        provideBuffers(bufferId, 1);
+        return;
+    }
+    //entries start at the ring itself: compiled as C++ the header's bufs member sits 8 bytes in, after an empty struct
+    io_uring_buf& entry = reinterpret_cast<io_uring_buf*>(bufferRing)[ringTail & (bufferCount - 1)]; //resv of the first entry is the tail, left alone
+    entry.addr = reinterpret_cast<uint64_t>(buffers + static_cast<size_t>(bufferId) * bufferSize);
+    entry.len = bufferSize;
+    entry.bid = bufferId;
+    ringTail++;
+    __atomic_store_n(&bufferRing->tail, ringTail, __ATOMIC_RELEASE); //entry is visible before the kernel sees the new tail
+}
+
+void ECE_UringServer::provideBuffers(unsigned short firstId, unsigned count)
+{
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+    sqe->fd = static_cast<int>(count);
+    sqe->addr = reinterpret_cast<uint64_t>(buffers + static_cast<size_t>(firstId) * bufferSize);
+    sqe->len = bufferSize;
+    sqe->off = firstId;
+    sqe->buf_group = 0;
+    sqe->flags = IOSQE_CQE_SKIP_SUCCESS; //only a failure needs a completion
+    sqe->user_data = encodeData(OP_PROVIDE, 0, 0);
+}
+
+ECE_UringServer::UringConnection* ECE_UringServer::lookup(ConnectionId id)
+{
+    if (id.slot >= connections.size())
+    {
+        return nullptr;
+    }
+    UringConnection& connection = connections[id.slot];
+    return (connection.open && connection.generation == id.generation) ? &connection : nullptr;
+}
+
+void ECE_UringServer::onAccept(const io_uring_cqe& cqe)
+{
+    if (!(cqe.flags & IORING_CQE_F_MORE)) //kernel ended the multishot accept
+    {
+        armAccept();
+    }
+    if (cqe.res < 0)
+    {
+        cout << "Error" << endl;
+        return;
+    }
+
+    int fd = cqe.res;
+    if (exiting) //no new clients once the exit message is on its way
+    {
+        ::close(fd);
+        return;
+    }
+    sockaddr_in peer;
+    socklen_t length = sizeof(peer);
+    memset(&peer, 0, sizeof(peer));
+    getpeername(fd, reinterpret_cast<sockaddr*>(&peer), &length);
+    {
+        lock_guard<mutex> lock(connectionsMutex);
+        if (static_cast<size_t>(fd) >= connections.size())
+        {
+            connections.resize(fd + 1);
+        }
+        UringConnection& connection = connections[fd];
+        connection.open = true;
+        connection.peer = peer;
+        connection.features = 0; //a new client starts on the plain protocol
+    }
+    timers.start(static_cast<uint32_t>(fd), currentTick());
+    armRecv(fd);
+}
+
+void ECE_UringServer::onRecv(const io_uring_cqe& cqe)
+{
+    int fd = static_cast<int>((cqe.user_data >> 32) & 0xFFFFFF);
+    ConnectionId id = {static_cast<uint32_t>(fd), static_cast<uint32_t>(cqe.user_data)};
+    bool hasBuffer = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+    unsigned short bufferId = static_cast<unsigned short>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+
+    if (cqe.res > 0 && lookup(id) != nullptr && !exiting) //messages arriving after the exit message are dropped
+    {
+        timers.touch(static_cast<uint32_t>(fd), currentTick()); //any traffic counts as a heartbeat
+        consume(fd, buffers + static_cast<size_t>(bufferId) * bufferSize, static_cast<size_t>(cqe.res));
+    }
+    if (hasBuffer) //given back even when the client is gone
+    {
+        returnBuffer(bufferId);
+    }
+
+    if (lookup(id) == nullptr) //stale completion or closed by the handler
+    {
+        return;
+    }
+    if (cqe.res == 0 || (cqe.res < 0 && cqe.res != -ENOBUFS)) //client disconnected
+    {
+        close(id);
+        return;
+    }
+    if (!(cqe.flags & IORING_CQE_F_MORE)) //out of buffers or ended by the kernel, buffers given back go ahead of it in the queue
+    {
+        armRecv(fd);
+    }
+}
+
+void ECE_UringServer::onSend(const io_uring_cqe& cqe)
+{
+    inFlight.erase(cqe.user_data);
+    int fd = static_cast<int>((cqe.user_data >> 32) & 0xFFFFFF);
+    ConnectionId id = {static_cast<uint32_t>(fd), static_cast<uint32_t>(cqe.user_data)};
+    UringConnection* connection = lookup(id);
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    connection->sending = false;
+    if (cqe.res < 0)
+    {
+        close(id);
+        return;
+    }
+    connection->sentOfFront += static_cast<size_t>(cqe.res);
+    if (connection->sentOfFront >= connection->outbox.front().frame->size()) //short sends continue from where they stopped
+    {
+        connection->outbox.pop_front();
+        connection->sentOfFront = 0;
+    }
+    if (!connection->outbox.empty() || !connection->pending.empty())
+    {
+        armSend(fd);
+    }
+}
+
+void ECE_UringServer::onWritable(const io_uring_cqe& cqe)
+{
+    int fd = static_cast<int>((cqe.user_data >> 32) & 0xFFFFFF);
+    ConnectionId id = {static_cast<uint32_t>(fd), static_cast<uint32_t>(cqe.user_data)};
+    UringConnection* connection = lookup(id);
+    if (connection == nullptr)
+    {
+        return;
+    }
+
+    connection->sending = false;
+    if (cqe.res < 0)
+    {
+        close(id);
+        return;
+    }
+    armSend(fd); //next slice of the replay
+}
+
+void ECE_UringServer::onTick()
+{
+    armTimeout();
+    if (exiting) //the exit deadline takes over from the timers
+    {
+        return;
+    }
+    timerEvents.clear();
+    timers.advance(currentTick(), timerEvents);
+    for (auto& timer : timerEvents)
+    {
+        if (!connections[timer.key].open) //closed by an earlier event
+        {
+            continue;
+        }
+        ConnectionId id = {timer.key, connections[timer.key].generation};
+        if (timer.idle) //no answer to the heartbeat
+        {
+            cout << "Client timed out." << endl;
+            close(id);
+        }
+        else
+        {
+            tcpMessage heartbeat = {MSG_VERSION, MSG_TYPE_HEARTBEAT, 1, ""};
+            send(id, heartbeat); //queued like any other frame, so it never lands inside one
+        }
+    }
+}
+
+void ECE_UringServer::consume(int fd, const char* data, size_t size)
+{
+    UringConnection& connection = connections[fd];
+    ConnectionId id = {static_cast<uint32_t>(fd), connection.generation};
+    string& input = connection.input;
+
+    //frames are parsed straight out of the receive buffer unless part of one is already waiting
+    if (!input.empty())
+    {
+        input.append(data, size);
+        data = input.data();
+        size = input.size();
+    }
+
+    size_t used = 0;
+    while (size - used >= FRAME_HEADER)
+    {
+        size_t payload = getBigEndian(data + used, FRAME_HEADER);
+        if (payload > MAX_BATCH_FRAME - FRAME_HEADER) //no valid message or batch is this long
+        {
+            cout << "Malformed message from port " << ntohs(connection.peer.sin_port) << "." << endl;
+            close(id);
+            return;
+        }
+        if (size - used < FRAME_HEADER + payload) //rest of the frame is still on its way
+        {
+            break;
+        }
+
+        const char* frame = data + used + FRAME_HEADER;
+        used += FRAME_HEADER + payload;
+        if (isBatch(frame, payload)) //every message of the batch, read straight out of the buffer
+        {
+            forEachInBatch(frame, payload, batchScratch, [&](tcpMessage& message) {
+                if (lookup(id) != nullptr) //an earlier message may have closed the client
+                {
+                    handler(*this, id, message);
+                }
+            });
+        }
+        else
+        {
+            tcpMessage message;
+            if (decodePayload(frame, payload, message))
+            {
+                handler(*this, id, message);
+            }
+        }
+        if (lookup(id) == nullptr) //handler closed the client
+        {
+            return;
+        }
+    }
+
+    if (data == input.data())
+    {
+        input.erase(0, used);
+    }
+    else
+    {
+        input.assign(data + used, size - used);
+    }
+}
+
+void ECE_UringServer::enqueue(int fd, const Outgoing& item)
+{
+    UringConnection& connection = connections[fd];
+    if ((connection.features & FEATURE_BATCH) && item.frame && !isBatch(item.frame->data() + FRAME_HEADER, item.frame->size() - FRAME_HEADER))
+    {
+        if (!connection.pending.addFrame(item.frame->data(), item.frame->size())) //batch full, it queues and the next one starts
+        {
+            sealBatch(connection);
+            connection.pending.addFrame(item.frame->data(), item.frame->size());
+        }
+    }
+    else
+    {
+        if (!connection.pending.empty()) //batched frames were queued first, so they go first
+        {
+            sealBatch(connection);
+        }
+        connection.outbox.push_back(item);
+    }
+    if (!connection.sending && !connection.queued)
+    {
+        connection.queued = true;
+        dirty.push_back(fd);
+    }
+}
+
+void ECE_UringServer::sealBatch(UringConnection& connection)
+{
+    auto frame = make_shared<string>();
+    connection.pending.finish(*frame, (connection.features & FEATURE_COMPRESS) != 0);
+    connection.pending.clear();
+    connection.outbox.push_back({frame, 0});
+}
+
+void ECE_UringServer::flushSends()
+{
+    for (int fd : dirty)
+    {
+        UringConnection& connection = connections[fd];
+        connection.queued = false;
+        if (connection.open && !connection.sending)
+        {
+            armSend(fd);
+        }
+    }
+    dirty.clear();
+}
+
+void ECE_UringServer::startExit()
+{
+    exiting = true;
+    exitDeadline = chrono::steady_clock::now() + chrono::seconds(2);
+    Frame frame;
+    {
+        lock_guard<mutex> lock(connectionsMutex);
+        frame = make_shared<string>(exitFrame);
+    }
+    for (size_t fd = 0; fd < connections.size(); fd++) //behind whatever each client already has queued, so nothing is cut short
+    {
+        if (connections[fd].open)
+        {
+            enqueue(static_cast<int>(fd), {frame, 0});
+        }
+    }
+}
+
+bool ECE_UringServer::exitDrained()
+{
+    if (chrono::steady_clock::now() >= exitDeadline) //a client that stopped reading does not hold up the exit
+    {
+        return true;
+    }
+    for (auto& connection : connections)
+    {
+        if (connection.open && (connection.sending || !connection.outbox.empty() || !connection.pending.empty()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ECE_UringServer::send(ConnectionId id, const tcpMessage& message)
+{
+    if (lookup(id) == nullptr)
+    {
+        return;
+    }
+    auto frame = make_shared<string>(MAX_FRAME, '\0');
+    frame->resize(encodeFrame(message, &(*frame)[0]));
+    enqueue(static_cast<int>(id.slot), {frame, 0});
+}
+
+void ECE_UringServer::broadcast(ConnectionId sender, const tcpMessage& message)
+{
+    auto frame = make_shared<string>(MAX_FRAME, '\0');
+    frame->resize(encodeFrame(message, &(*frame)[0]));
+    for (size_t fd = 0; fd < connections.size(); fd++) //every client queues the same frame, it is encoded once
+    {
+        if (connections[fd].open && fd != sender.slot)
+        {
+            enqueue(static_cast<int>(fd), {frame, 0});
+        }
+    }
+}
+
+void ECE_UringServer::replay(ConnectionId id, uint64_t offset)
+{
+    if (lookup(id) == nullptr)
+    {
+        return;
+    }
+    enqueue(static_cast<int>(id.slot), {nullptr, offset});
+}
+
+void ECE_UringServer::close(ConnectionId id)
+{
+    UringConnection* connection = lookup(id);
+    if (connection == nullptr) //already closed
+    {
+        return;
+    }
+    {
+        lock_guard<mutex> lock(connectionsMutex);
+        connection->open = false;
+        connection->generation++;
+    }
+    timers.stop(id.slot);
+    connection->input.clear();
+    connection->outbox.clear();
+    connection->pending.clear();
+    connection->sentOfFront = 0;
+    connection->sending = false;
+
+    //shutdown ends the multishot receive and any send still in flight before the descriptor is reused
+    shutdown(static_cast<int>(id.slot), SHUT_RDWR);
+    ::close(static_cast<int>(id.slot));
+}
+
+void ECE_UringServer::setFeatures(ConnectionId id, unsigned short features)
+{
+    UringConnection* connection = lookup(id);
+    if (connection != nullptr)
+    {
+        connection->features = features;
+    }
+}
+
+void ECE_UringServer::printClients()
+{
+    lock_guard<mutex> lock(connectionsMutex);
+    size_t count = count_if(connections.begin(), connections.end(), [](const UringConnection& c) { return c.open; });
+    cout << "Number of Clients: " << count << endl;
+    for (auto& connection : connections)
+    {
+        if (connection.open)
+        {
+            cout << "IP Address : " << inet_ntoa(connection.peer.sin_addr) << " | Port : " << ntohs(connection.peer.sin_port) << endl;
+        }
+    }
+}
+
+void ECE_UringServer::requestExit(const tcpMessage& exitMessage)
+{
+    {
+        lock_guard<mutex> lock(connectionsMutex);
+        exitFrame.resize(MAX_FRAME);
+        exitFrame.resize(encodeFrame(exitMessage, &exitFrame[0]));
+    }
+    exitRequested = true;
+    while (true) //the event loop sends the exit message and ends the program once it is out
+    {
+        this_thread::sleep_for(chrono::milliseconds(100));
+    }
+}
+
+void ECE_UringServer::run()
+{
+    armAccept();
+    armTimeout();
+    while (true)
+    {
+        enter(1); //sends queued last pass go out with this call
+
+        unsigned head = *cqHead;
+        unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail)
+        {
+            io_uring_cqe cqe = cqes[head & *cqMask];
+            head++;
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+
+            switch (static_cast<Operation>(cqe.user_data >> 56))
+            {
+            case OP_ACCEPT:
+                onAccept(cqe);
+                break;
+            case OP_RECV:
+                onRecv(cqe);
+                break;
+            case OP_SEND:
+                onSend(cqe);
+                break;
+            case OP_WRITABLE:
+                onWritable(cqe);
+                break;
+            case OP_TIMEOUT:
+                onTick();
+                break;
+            case OP_PROVIDE:
+                cout << "Receive buffers refused: " << strerror(-cqe.res) << endl;
+                break;
+            }
+        }
+
+        if (exitRequested && !exiting)
+        {
+            startExit();
+        }
+        else if (exiting && exitDrained())
+        {
+            lock_guard<mutex> lock(connectionsMutex);
+            for (size_t fd = 0; fd < connections.size(); fd++)
+            {
+                if (connections[fd].open)
+                {
+                    shutdown(static_cast<int>(fd), SHUT_RDWR);
+                }
+            }
+            cout << "Goodbye." << endl;
+            exit(0);
+        }
+
+        flushSends();
+    }
+}
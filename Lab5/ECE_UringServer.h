@@ -0,0 +1,155 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for the io_uring backend of the server. One multishot accept and one multishot recv
+per client stay armed in the ring, received data lands in a registered ring of buffers the
+kernel picks from (provided with IORING_OP_PROVIDE_BUFFERS on kernels without buffer rings),
+and every send of a loop pass goes to the kernel in a single io_uring_enter call. Heartbeats and
+idle timeouts run off the connection table's timer wheel like the SFML backend, advanced by the
+timeout that already wakes the loop. The ring is driven through the raw system calls so the
+backend needs nothing beyond the kernel headers.
+
+*/
+
+#ifndef LAB5_ECE_URINGSERVER_H
+#define LAB5_ECE_URINGSERVER_H
+
+//directives
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <cstdint>
+#include <netinet/in.h>
+#include <linux/io_uring.h>
+#include "ECE_ServerBackend.h"
+#include "ECE_MessageLog.h"
+#include "ECE_MessageBatch.h"
+#include "ECE_TimerWheel.h"
+
+class ECE_UringServer : public ECE_ServerBackend //io_uring event loop, clients are identified by (file descriptor, generation)
+{
+public:
+    ECE_UringServer(MessageHandler handler, ECE_MessageLog& log, unsigned entries = 256, unsigned bufferCount = 256,
+                    unsigned bufferSize = 4096); //sets up the ring and hands it the receive buffers
+    ~ECE_UringServer() override;
+
+    bool listen(unsigned short port) override;
+    void run() override;
+
+    void send(ConnectionId id, const tcpMessage& message) override;
+    void broadcast(ConnectionId sender, const tcpMessage& message) override;
+    void replay(ConnectionId id, uint64_t offset) override;
+    void close(ConnectionId id) override;
+    void setFeatures(ConnectionId id, unsigned short features) override;
+
+    void printClients() override;
+    void requestExit(const tcpMessage& exitMessage) override;
+
+private:
+    typedef std::shared_ptr<const std::string> Frame; //one encoded frame, shared by every client it is queued for
+
+    struct Outgoing //queued for one client, a frame to send or a replay to run
+    {
+        Frame frame; //null for a replay
+        uint64_t replayFrom = 0;
+        bool started = false; //replay cursor has been pointed at the log
+        ReplayCursor replay {}; //how far the replay has got, it carries on each time the socket is writable
+    };
+
+    struct UringConnection //state of one client, indexed by file descriptor
+    {
+        bool open = false;
+        uint32_t generation = 0; //bumped on close so completions for an earlier client are recognised
+        sockaddr_in peer;
+        std::string input; //bytes of a frame that has not fully arrived
+        std::deque<Outgoing> outbox;
+        ECE_MessageBatch pending; //frames for a batching client, combined as they are queued and sent behind the outbox
+        std::size_t sentOfFront = 0; //bytes of the first frame already sent
+        bool sending = false; //one send (or wait to continue a replay) in flight at a time keeps frames in order
+        bool queued = false; //already on the dirty list
+        unsigned short features = 0; //protocol extensions agreed with a HELLO
+    };
+
+    enum Operation : uint8_t { OP_ACCEPT = 1, OP_RECV, OP_SEND, OP_TIMEOUT, OP_PROVIDE, OP_WRITABLE };
+
+    static uint64_t encodeData(Operation op, int fd, uint32_t generation); //user_data of a submission
+    io_uring_sqe* nextSqe(); //next free submission entry, submits if the queue is full
+    void enter(unsigned waitFor); //submits queued entries and waits for waitFor completions
+
+    void armAccept();
+    void armRecv(int fd);
+    void armTimeout();
+    void armSend(int fd);
+    void armWritable(int fd); //asks for a completion once the client's socket has room, to continue a replay
+    bool registerBufferRing(); //registers the ring of receive buffers, false if the kernel has no buffer rings
+    void returnBuffer(unsigned short bufferId); //gives a used receive buffer back to the kernel
+    void provideBuffers(unsigned short firstId, unsigned count); //gives receive buffers (back) without a buffer ring
+
+    void onAccept(const io_uring_cqe& cqe);
+    void onRecv(const io_uring_cqe& cqe);
+    void onSend(const io_uring_cqe& cqe);
+    void onWritable(const io_uring_cqe& cqe);
+    void onTick(); //advances the timer wheel, sending heartbeats and dropping idle clients
+    void consume(int fd, const char* data, std::size_t size); //splits received bytes into frames and handles each
+    void enqueue(int fd, const Outgoing& item); //adds to a client's outbox and marks it for the next submit
+    static void sealBatch(UringConnection& connection); //moves a batching client's pending frames to its outbox as one batch frame
+    void flushSends(); //starts a send on every client with queued data and none in flight
+    void startExit(); //queues the exit message behind everything each client is still owed
+    bool exitDrained(); //true once every client has been sent all of it, or the grace period is over
+    UringConnection* lookup(ConnectionId id); //null if the client has gone
+
+    MessageHandler handler;
+    ECE_MessageLog& log;
+    int listenFd = -1;
+    int ringFd = -1;
+
+    //submission and completion queues shared with the kernel
+    void* sqRing = nullptr;
+    void* cqRing = nullptr;
+    std::size_t sqRingSize = 0;
+    std::size_t cqRingSize = 0;
+    io_uring_sqe* sqes = nullptr;
+    std::size_t sqesSize = 0;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    unsigned sqEntries;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    io_uring_cqe* cqes;
+    unsigned localTail = 0; //entries written, published to the kernel on enter
+    unsigned submitted = 0; //entries the kernel has taken
+
+    //receive buffers and the ring they are handed to the kernel through
+    char* buffers = nullptr;
+    unsigned bufferCount;
+    unsigned bufferSize;
+    io_uring_buf_ring* bufferRing = nullptr; //null when the buffers are provided instead
+    std::size_t bufferRingSize = 0;
+    unsigned short ringTail = 0; //entries added, published to the kernel as the ring's tail
+
+    __kernel_timespec tick; //wakes the loop so an exit request is noticed and the timer wheel advances
+    ECE_TimerWheel timers{HEARTBEAT_TICKS, IDLE_TICKS}; //keyed by file descriptor
+    std::vector<TimerEvent> timerEvents;
+    std::vector<UringConnection> connections;
+    std::vector<int> dirty; //clients with sends to start
+    std::unordered_map<uint64_t, Frame> inFlight; //frames the kernel is still reading, by user_data
+    std::mutex connectionsMutex; //guards open flags and peers between the loop and the console
+    std::string batchScratch; //body of a compressed batch while it is handled
+    std::atomic<bool> exitRequested{false};
+    std::string exitFrame;
+    bool exiting = false; //exit message queued, waiting for the outboxes to drain
+    std::chrono::steady_clock::time_point exitDeadline; //clients still not drained by then are cut off
+};
+
+#endif
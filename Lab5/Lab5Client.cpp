@@ -1,7 +1,7 @@
 /*
 Author: Abby McCollam
 Class: ECE4122 Section A
-Last Date Modified: 11/26/23
+Last Date Modified: 10/19/26
 Description: Client communicating to server
 */
 
@@ -16,6 +16,9 @@ Description: Client communicating to server
 #include <cstdlib>
 #include <chrono>
 #include <thread>
+#include <atomic>
+#include "ECE_TcpMessage.h"
+#include "ECE_MessageBatch.h"
 
 //creating instances of classes
 sf::Packet packet;
@@ -23,17 +26,12 @@ sf::TcpSocket socket;
 sf::SocketSelector selector;
 
 bool loop = true;
+std::atomic<unsigned short> serverFeatures(0); //protocol extensions the server agreed to
+std::atomic<uint64_t> nextRecord(0); //first log offset this client has not seen, what a reconnect replays from
+std::string batchScratch; //body of a compressed batch while it is printed
 
 using namespace std;
 
-struct tcpMessage //Data using following packet structure
-{
-    unsigned char nVersion;
-    unsigned char nType;
-    unsigned short nMsgLen;
-    char chMsg[1000];
-};
-
 //initializing message structure
 tcpMessage rcvMessage = {102, 77, 1, ' '};
 
@@ -72,6 +70,70 @@ void ifTypeT(string mes, unsigned long var) //if t is entered
         cout << "Please enter valid input." << endl;
 }
 
+void ifTypeR(unsigned long var) //if r is entered, asks the server to replay history from log offset var
+{
+    tcpMessage request = {rcvMessage.nVersion, MSG_TYPE_REPLAY, 1, ""};
+    snprintf(request.chMsg, sizeof(request.chMsg), "%lu", var);
+
+    sf::Packet replayPacket;
+    replayPacket << request.nVersion << request.nType << request.nMsgLen << request.chMsg;
+    if (socket.send(replayPacket) != sf::Socket::Done)
+    {
+        cout << "Replay request failed." << endl;
+    }
+}
+
+void ifTypeB(const string& mes, unsigned long count) //if b is entered, broadcasts the message count times in one batch
+{
+    tcpMessage message = {MSG_VERSION, MSG_TYPE_BROADCAST, 1, ""};
+    strncpy(message.chMsg, mes.substr(mes.empty() ? 0 : 1).c_str(), sizeof(message.chMsg) - 1);
+
+    if (!(serverFeatures & FEATURE_BATCH)) //server only speaks the plain protocol
+    {
+        for (unsigned long i = 0; i < count; i++)
+        {
+            sf::Packet plainPacket;
+            plainPacket << message.nVersion << message.nType << message.nMsgLen << message.chMsg;
+            socket.send(plainPacket);
+        }
+        return;
+    }
+
+    ECE_MessageBatch batch;
+    string frame;
+    for (unsigned long i = 0; i <= count; i++)
+    {
+        if (i < count && batch.add(message))
+        {
+            continue;
+        }
+        //all added or batch full, sending what is collected
+        if (batch.empty())
+        {
+            break;
+        }
+        batch.finish(frame, (serverFeatures & FEATURE_COMPRESS) != 0);
+        size_t offset = 0;
+        sf::Socket::Status status = sf::Socket::Partial;
+        while (status == sf::Socket::Partial) //already framed, the bytes go out as they are
+        {
+            size_t sent = 0;
+            status = socket.send(frame.data() + offset, frame.size() - offset, sent);
+            offset += sent;
+        }
+        if (status != sf::Socket::Done)
+        {
+            cout << "Batch send failed." << endl;
+            return;
+        }
+        batch.clear();
+        if (i < count)
+        {
+            batch.add(message);
+        }
+    }
+}
+
 void ifTypeQ()
 {
     rcvMessage.nType = 1; //changing version to 1
@@ -81,14 +143,57 @@ void ifTypeQ()
         //continue;
     }
     cout << "Socket closed." << endl;
+    cout << "Reconnect with log offset " << nextRecord << " to catch up." << endl;
     exit(1);
 }
 
+void seenRecord(uint64_t next) //the client has every logged message before next
+{
+    if (next > nextRecord) //only the receive thread writes it
+    {
+        nextRecord = next;
+    }
+}
+
+void handleServerMessage(tcpMessage& message) //acts on one message from the server
+{
+    if (message.nVersion == 1) //if packet has nVersion = 1, close connection
+    {
+        cout << "Connection closed from server." << endl;
+        cout << "Reconnect with log offset " << nextRecord << " to catch up." << endl;
+        exit(1);
+    }
+    else if (message.nVersion == MSG_VERSION_BATCH && message.nType == MSG_TYPE_HELLO) //server answered the HELLO
+    {
+        serverFeatures = message.nMsgLen;
+    }
+    else if (message.nType == MSG_TYPE_HEARTBEAT) //answering quietly so the server keeps the connection
+    {
+        sf::Packet heartbeatPacket;
+        heartbeatPacket << message.nVersion << message.nType << message.nMsgLen << message.chMsg;
+        socket.send(heartbeatPacket);
+    }
+    else if (message.nType == MSG_TYPE_REPLAY) //replay finished, the server says how far the log goes
+    {
+        seenRecord(strtoull(message.chMsg, nullptr, 10));
+        cout << "Caught up to log offset " << nextRecord << "." << endl;
+    }
+    else //otherwise output this information
+    {
+        if (message.nRecord != NO_RECORD) //a logged broadcast, live or replayed
+        {
+            seenRecord(message.nRecord + 1);
+        }
+        cout << "Received Msg Type: " << +message.nType << "; Msg: " << message.chMsg << endl;
+        loop = true;
+    }
+}
+
 int main(int argc, char* argv[])
 {
-    if (argc != 3) //checks for valid number of input arguments
+    if (argc != 3 && argc != 4) //checks for valid number of input arguments
     {
-        cout << "Usage:./ClientTCP <IP Address> <port>" << endl;
+        cout << "Usage:./ClientTCP <IP Address> <port> [log offset to catch up from]" << endl;
         return 1;
     }
 
@@ -102,6 +207,17 @@ int main(int argc, char* argv[])
 
     selector.add(socket); //adding to selector to monitor activity
 
+    //offering batch frames, a server that does not know them never answers and messages stay plain
+    tcpMessage hello = {MSG_VERSION_BATCH, MSG_TYPE_HELLO, FEATURE_BATCH | FEATURE_COMPRESS, ""};
+    sf::Packet helloPacket;
+    helloPacket << hello.nVersion << hello.nType << hello.nMsgLen << hello.chMsg;
+    socket.send(helloPacket);
+
+    if (argc == 4) //reconnecting, history since the offset the last run printed comes first
+    {
+        ifTypeR(stoul(argv[3]));
+    }
+
     //BEGIN OPENMP
 #pragma omp parallel sections
     {
@@ -149,6 +265,14 @@ int main(int argc, char* argv[])
                 {
                     ifTypeT(message, temp);
                 }
+                else if (index == "b") //if b command, broadcast a burst of messages in one batch
+                {
+                    ifTypeB(message, temp);
+                }
+                else if (index == "r") //if r command, replay missed messages
+                {
+                    ifTypeR(temp);
+                }
                 else if (index == "q") //if q command, terminate program
                 {
                     ifTypeQ();
@@ -169,18 +293,20 @@ int main(int argc, char* argv[])
                             continue;
                         }
 
-                        packet >> rcvMessage.nVersion >> rcvMessage.nType >> rcvMessage.nMsgLen >> rcvMessage.chMsg; //extracts received message
-                        if (rcvMessage.nVersion == 1) //if packet has nVersion = 1, close connection
+                        const char* data = static_cast<const char*>(packet.getData());
+                        if (isBatch(data, packet.getDataSize())) //every message of the batch, read straight out of the packet
                         {
-                            cout << "Connection closed from server." << endl;
-                            exit(1);
-                        }
-                        else //otherwise output this information
-                        {
-                            cout << "Received Msg Type: " << +rcvMessage.nType << "; Msg: " << rcvMessage.chMsg << endl;
-                            loop = true;
+                            if (!forEachInBatch(data, packet.getDataSize(), batchScratch, handleServerMessage))
+                            {
+                                cout << "Malformed batch from server." << endl;
+                            }
                             continue;
                         }
+
+                        packet >> rcvMessage.nVersion >> rcvMessage.nType >> rcvMessage.nMsgLen >> rcvMessage.chMsg; //extracts received message
+                        sf::Uint64 record;
+                        rcvMessage.nRecord = (!packet.endOfPacket() && (packet >> record)) ? record : NO_RECORD; //only logged broadcasts carry one
+                        handleServerMessage(rcvMessage);
                     }
                 }
             }
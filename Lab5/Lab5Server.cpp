@@ -1,7 +1,7 @@
 /*
 Author: Abby McCollam
 Class: ECE4122 Section A
-Last Date Modified: 11/26/23
+Last Date Modified: 10/19/26
 Description: Server prompting user for commands to execute
 */
 
@@ -13,110 +13,565 @@ Description: Server prompting user for commands to execute
 #include <cstring>
 #include <omp.h>
 #include <algorithm>
-#include <list>
 #include <cstdlib>
+#include <mutex>
+#include <vector>
+#include <chrono>
+#include <csignal>
+#include "ECE_TcpMessage.h"
+#include "ECE_MessageLog.h"
+#include "ECE_ConnectionTable.h"
+#include "ECE_ServerBackend.h"
+#include "ECE_MessageBatch.h"
+#include "ECE_UringServer.h"
 
 using namespace std;
 
 //creating instances of classes
-list<sf::TcpSocket*> clients;
+ECE_ConnectionTable clients(HEARTBEAT_TICKS, IDLE_TICKS);
+mutex clientsMutex; //guards clients and selector between the event loop and the console
 sf::SocketSelector selector;
 sf::TcpListener listener;
 sf::Packet exitPacket;
 sf::Packet packet;
-sf::Packet packet77;
-sf::Packet packet201;
-
-struct tcpMessage //Data using following packet structure
-{
-    unsigned char nVersion;
-    unsigned char nType;
-    unsigned short nMsgLen;
-    char chMsg[1000];
-};
+string batchScratch; //body of a compressed batch while it is handled
 
 //initializing message structure
 tcpMessage lastMessageReceived = { 102, 77, 1, ' '};
+mutex lastMessageMutex; //guards lastMessageReceived between the receive loop and the console
+ECE_MessageLog* messageLog = nullptr; //persistent history of broadcast messages
+ECE_ServerBackend* server = nullptr; //backend chosen on the command line
 string command;
 
 //acquiring and printing connected clients list
 void printConnectedClients()
 {
+    lock_guard<mutex> lock(clientsMutex);
     cout << "Number of Clients: " << clients.size() << endl;
-    for (list<sf::TcpSocket*>::iterator it = clients.begin(); it != clients.end(); ++it)
+    for (uint32_t slot = clients.first(); slot != NO_SLOT; slot = clients.next(slot))
     {
-        sf::TcpSocket& client = **it;
+        sf::TcpSocket& client = clients.at(slot).socket;
         cout << "IP Address : " << client.getRemoteAddress() << " | Port : " << client.getRemotePort() << endl;
     }
 }
 
 void timeToExit() //exit function when q pressed
 {
-    lastMessageReceived.chMsg[0] = 'q';
-    lastMessageReceived.nVersion = 1; //setting nVersion to 1 and it is read by client
-    exitPacket << lastMessageReceived.nVersion << lastMessageReceived.nType << lastMessageReceived.nMsgLen << lastMessageReceived.chMsg; //exit packet
-    for (list<sf::TcpSocket*>::iterator it = clients.begin(); it != clients.end(); ++it) //sending exit message to clients
+    messageLog->flush(); //making sure every logged message reaches disk
+    tcpMessage exitMessage;
     {
-        sf::TcpSocket& client = **it;
-        if (client.send(exitPacket) != sf::Socket::Done)
-            continue;
-        client.disconnect();
+        lock_guard<mutex> lock(lastMessageMutex);
+        lastMessageReceived.chMsg[0] = 'q';
+        lastMessageReceived.nVersion = 1; //setting nVersion to 1 and it is read by client
+        exitMessage = lastMessageReceived;
+    }
+    server->requestExit(exitMessage);
+}
+
+void processType201(tcpMessage& message) //function for when version 201 chosen
+{
+    reverse(message.chMsg, message.chMsg + strlen(message.chMsg)); //reverse order
+}
+
+void handleMessage(ECE_ServerBackend& backend, ConnectionId id, tcpMessage& message) //handles one message, shared by every backend
+{
+    {
+        lock_guard<mutex> lock(lastMessageMutex);
+        lastMessageReceived = message;
+    }
+
+    //handles message based on version number
+    if (message.nVersion == MSG_VERSION_BATCH && message.nType == MSG_TYPE_HELLO) //client offering batch frames
+    {
+        unsigned short agreed = message.nMsgLen & (FEATURE_BATCH | FEATURE_COMPRESS);
+        if (!(agreed & FEATURE_BATCH)) //compression only exists inside batches
+        {
+            agreed = 0;
+        }
+        tcpMessage reply = {MSG_VERSION_BATCH, MSG_TYPE_HELLO, agreed, ""};
+        backend.send(id, reply); //still a plain frame, batching starts after it
+        backend.setFeatures(id, agreed);
+    }
+    else if (message.nVersion != MSG_VERSION) //version number 102
+    {
+        return; //do nothing
+    }
+    else if (message.nType == MSG_TYPE_REVERSE) //version number 201
+    {
+        processType201(message);
+        backend.send(id, message);
+    }
+    else if (message.nType == MSG_TYPE_BROADCAST) //version number 77
+    {
+        messageLog->append(message); //recording the message so reconnecting clients can catch up
+        backend.broadcast(id, message);
+    }
+    else if (message.nType == MSG_TYPE_REPLAY) //client catching up on history
+    {
+        backend.replay(id, strtoull(message.chMsg, nullptr, 10)); //first log offset the client is missing
+    }
+    else if (message.nType == MSG_TYPE_CLOSE) //client is leaving
+    {
+        cout << "Connection closed from client." << endl;
+        backend.close(id);
     }
-    cout << "Goodbye." << endl;
-    exit(0);
+}
+
+void closeConnection(ConnectionId id) //removes a client from the selector and frees its slot
+{
+    Connection* connection = clients.get(id);
+    if (connection == nullptr) //already closed
+    {
+        return;
+    }
+    selector.remove(connection->socket);
+    connection->socket.disconnect();
+    clients.remove(id);
 }
 
 void readyForClient() //function for accepting new client connections
 {
-    sf::TcpSocket* socket = new sf::TcpSocket;
-    if (listener.accept(*socket) != sf::Socket::Done)
+    ConnectionId id = clients.add(currentTick());
+    sf::TcpSocket& socket = clients.get(id)->socket;
+    if (listener.accept(socket) != sf::Socket::Done)
     {
         cout << "Error" << endl;
-        delete socket;
+        clients.remove(id); //slot goes straight back to the free list
+        return;
+    }
+    selector.add(socket);
+}
+
+void holdMessage(Connection& connection, const tcpMessage& message) //keeps a message back until the client's replay is done
+{
+    size_t used = connection.held.size();
+    connection.held.resize(used + MAX_FRAME);
+    connection.held.resize(used + encodeFrame(message, &connection.held[used]));
+}
+
+void sendPacket(ConnectionId id, const tcpMessage& message) //sends one message to one client
+{
+    if (clients.get(id)->replaying) //the socket may be in the middle of a replayed frame
+    {
+        holdMessage(*clients.get(id), message);
+        return;
+    }
+    sf::Packet outgoing;
+    outgoing << message.nVersion << message.nType << message.nMsgLen << message.chMsg;
+    if (message.nRecord != NO_RECORD)
+    {
+        outgoing << sf::Uint64(message.nRecord);
+    }
+    sf::TcpSocket& socket = clients.get(id)->socket;
+    sf::Socket::Status status = socket.send(outgoing);
+    while (status == sf::Socket::Partial) //blocking socket, keep going until the packet is out
+    {
+        status = socket.send(outgoing);
+    }
+    if (status == sf::Socket::Disconnected || status == sf::Socket::Error)
+    {
+        closeConnection(id);
+    }
+}
+
+void flushBatch(ConnectionId id) //sends a batching client everything queued for it as one batch frame
+{
+    Connection* connection = clients.get(id);
+    if (connection == nullptr || connection->pending.empty())
+    {
+        return;
+    }
+    static string frame; //only the event loop thread sends batches
+    connection->pending.finish(frame, (connection->features & FEATURE_COMPRESS) != 0);
+    connection->pending.clear();
+    if (connection->replaying) //already framed, it waits with the rest
+    {
+        connection->held += frame;
+        return;
+    }
+
+    size_t offset = 0;
+    sf::Socket::Status status = sf::Socket::Partial;
+    while (status == sf::Socket::Partial) //already framed, the bytes go out as they are until all of them are sent
+    {
+        size_t sent = 0;
+        status = connection->socket.send(frame.data() + offset, frame.size() - offset, sent);
+        offset += sent;
+    }
+    if (status == sf::Socket::Disconnected || status == sf::Socket::Error)
+    {
+        closeConnection(id);
+    }
+}
+
+void queueBatched(ConnectionId id, const tcpMessage& message) //adds a message to a batching client's next batch
+{
+    Connection* connection = clients.get(id);
+    if (!connection->pending.add(message)) //batch full, sending it and starting the next one
+    {
+        flushBatch(id);
+        if ((connection = clients.get(id)) != nullptr)
+        {
+            connection->pending.add(message);
+        }
+    }
+}
+
+void flushAllBatches() //end of a loop pass, every batching client gets what was queued for it
+{
+    vector<ConnectionId> waiting; //collected first since a failed send closes the connection
+    for (uint32_t slot = clients.first(); slot != NO_SLOT; slot = clients.next(slot))
+    {
+        if (!clients.at(slot).pending.empty())
+        {
+            waiting.push_back(clients.idOf(slot));
+        }
+    }
+    for (auto& id : waiting)
+    {
+        flushBatch(id);
     }
-    clients.push_back(socket);
-    selector.add(*socket);
 }
 
-void processType201() //function for when version 201 chosen
+void sendHeartbeat(ConnectionId id) //asks a quiet client to prove it is still there
 {
-    reverse(lastMessageReceived.chMsg, lastMessageReceived.chMsg + strlen(lastMessageReceived.chMsg)); //reverse order
-    packet201 << lastMessageReceived.nVersion << lastMessageReceived.nType << lastMessageReceived.nMsgLen << lastMessageReceived.chMsg;
+    tcpMessage heartbeat = {MSG_VERSION, MSG_TYPE_HEARTBEAT, 1, ""};
+    if (clients.get(id)->features & FEATURE_BATCH) //queued behind the batched messages so it cannot overtake them
+    {
+        queueBatched(id, heartbeat);
+    }
+    else
+    {
+        sendPacket(id, heartbeat);
+    }
 }
 
-void processType77(const tcpMessage& message, sf::TcpSocket& client, const list<sf::TcpSocket*>& clientTemp) //function for when version 77 chosen
+void processType77(const tcpMessage& message, ConnectionId sender) //function for when version 77 chosen
 {
+    sf::Packet packet77;
     packet77 << message.nVersion << message.nType << message.nMsgLen << message.chMsg;
+    if (message.nRecord != NO_RECORD) //record number tells the client where to resume
+    {
+        packet77 << sf::Uint64(message.nRecord);
+    }
+
+    vector<ConnectionId> lost; //closed after the loop so the iteration stays valid
+    for (uint32_t slot = clients.first(); slot != NO_SLOT; slot = clients.next(slot))
+    {
+        if (slot == sender.slot)
+        {
+            continue;
+        }
+        if (clients.at(slot).features & FEATURE_BATCH) //goes out with the client's batch
+        {
+            queueBatched(clients.idOf(slot), message);
+            continue;
+        }
+        if (clients.at(slot).replaying) //goes out after the history
+        {
+            holdMessage(clients.at(slot), message);
+            continue;
+        }
+        sf::Socket::Status status = clients.at(slot).socket.send(packet77);
+        while (status == sf::Socket::Partial) //blocking socket, keep going until the packet is out
+        {
+            status = clients.at(slot).socket.send(packet77);
+        }
+        if (status == sf::Socket::Disconnected || status == sf::Socket::Error)
+        {
+            lost.push_back(clients.idOf(slot));
+        }
+    }
+    for (auto& id : lost)
+    {
+        closeConnection(id);
+    }
+}
+
+void processReplay(ConnectionId id, uint64_t offset) //function for when a client asks for history, streamed a slice per loop pass
+{
+    Connection* connection = clients.get(id);
+    if (connection->replaying) //one replay at a time, the client can ask again once this one is done
+    {
+        cout << "Replay to port " << connection->socket.getRemotePort() << " already running." << endl;
+        return;
+    }
+    if (messageLog->startReplay(offset, connection->replay))
+    {
+        connection->replaying = true;
+    }
+    else //nothing to send, the client is told where the log ends
+    {
+        server->send(id, replayDoneMessage(connection->replay.end));
+    }
+}
+
+void finishReplay(ConnectionId id) //history is out, releasing what was held back behind it
+{
+    Connection* connection = clients.get(id);
+    connection->replaying = false;
+    if (!connection->held.empty())
+    {
+        sf::Socket::Status status = connection->socket.send(connection->held.data(), connection->held.size()); //already framed
+        connection->held.clear();
+        if (status == sf::Socket::Disconnected || status == sf::Socket::Error)
+        {
+            closeConnection(id);
+            return;
+        }
+    }
+    server->send(id, replayDoneMessage(connection->replay.end));
+}
+
+bool advanceReplays() //sends every replaying client its next slice of history, true while any replay is unfinished
+{
+    vector<ConnectionId> finished;
+    vector<ConnectionId> lost; //both handled after the loop so the iteration stays valid
+    bool running = false;
+    for (uint32_t slot = clients.first(); slot != NO_SLOT; slot = clients.next(slot))
+    {
+        Connection& connection = clients.at(slot);
+        if (!connection.replaying)
+        {
+            continue;
+        }
+        long long sent = messageLog->continueReplay(connection.socket.getHandle(), connection.replay, REPLAY_SLICE);
+        if (sent < 0)
+        {
+            cout << "Replay to port " << connection.socket.getRemotePort() << " failed." << endl;
+            lost.push_back(clients.idOf(slot));
+            continue;
+        }
+        if (sent > 0) //the client is reading, which is as good as a heartbeat
+        {
+            clients.touch(clients.idOf(slot), currentTick());
+        }
+        if (connection.replay.done())
+        {
+            finished.push_back(clients.idOf(slot));
+        }
+        else
+        {
+            running = true;
+        }
+    }
+    for (auto& id : finished)
+    {
+        finishReplay(id);
+    }
+    for (auto& id : lost)
+    {
+        closeConnection(id);
+    }
+    return running;
+}
+
+void handleClient(ConnectionId id) //receives and handles one message from a ready client
+{
+    sf::TcpSocket& client = clients.get(id)->socket;
+    sf::Socket::Status status = client.receive(packet);
+    if (status == sf::Socket::Disconnected || status == sf::Socket::Error) //removes client if disconnected
+    {
+        closeConnection(id);
+        return;
+    }
+    if (status != sf::Socket::Done)
+    {
+        return;
+    }
+    clients.touch(id, currentTick()); //any traffic counts as a heartbeat
+
+    const char* data = static_cast<const char*>(packet.getData());
+    if (isBatch(data, packet.getDataSize())) //every message of the batch, read straight out of the packet
+    {
+        bool valid = forEachInBatch(data, packet.getDataSize(), batchScratch, [id](tcpMessage& message) {
+            if (clients.get(id) != nullptr) //an earlier message may have closed the client
+            {
+                handleMessage(*server, id, message);
+            }
+        });
+        if (!valid)
+        {
+            cout << "Malformed batch from client." << endl;
+        }
+        return;
+    }
+
+    tcpMessage message;
+    packet >> message.nVersion >> message.nType >> message.nMsgLen >> message.chMsg; //receives packet from client
+    handleMessage(*server, id, message);
+}
+
+class SfmlServer : public ECE_ServerBackend //socket selector loop with heartbeats and idle timeouts
+{
+public:
+    bool listen(unsigned short port) override
+    {
+        if (listener.listen(port) != sf::Socket::Done) //start listening to incoming connections
+        {
+            return false;
+        }
+        selector.add(listener); //new connections are handled by the event loop
+        return true;
+    }
+
+    void send(ConnectionId id, const tcpMessage& message) override
+    {
+        Connection* connection = clients.get(id);
+        if (connection == nullptr)
+        {
+            return;
+        }
+        if (connection->features & FEATURE_BATCH)
+        {
+            queueBatched(id, message);
+        }
+        else
+        {
+            sendPacket(id, message);
+        }
+    }
+
+    void broadcast(ConnectionId sender, const tcpMessage& message) override
+    {
+        processType77(message, sender);
+    }
+
+    void replay(ConnectionId id, uint64_t offset) override
+    {
+        if (clients.get(id) != nullptr)
+        {
+            processReplay(id, offset);
+        }
+    }
+
+    void close(ConnectionId id) override
+    {
+        closeConnection(id);
+    }
 
-    for (const auto& otherClient : clientTemp)
+    void setFeatures(ConnectionId id, unsigned short features) override
     {
-        sf::TcpSocket& other = *otherClient;
-        if (other.getRemotePort() != client.getRemotePort())
+        if (clients.get(id) != nullptr)
         {
-            bool cont = true;
-            while (cont)
+            clients.get(id)->features = features;
+        }
+    }
+
+    void printClients() override
+    {
+        printConnectedClients();
+    }
+
+    void requestExit(const tcpMessage& exitMessage) override
+    {
+        lock_guard<mutex> clientsLock(clientsMutex);
+        exitPacket << exitMessage.nVersion << exitMessage.nType << exitMessage.nMsgLen << exitMessage.chMsg; //exit packet
+        flushAllBatches(); //queued messages go out before the exit message
+        for (uint32_t slot = clients.first(); slot != NO_SLOT; slot = clients.next(slot)) //sending exit message to clients
+        {
+            sf::TcpSocket& client = clients.at(slot).socket;
+            if (clients.at(slot).replaying) //possibly in the middle of a replayed frame, only closed
+            {
+                client.disconnect();
+                continue;
+            }
+            if (client.send(exitPacket) != sf::Socket::Done)
+                continue;
+            client.disconnect();
+        }
+        cout << "Goodbye." << endl;
+        exit(0);
+    }
+
+    void run() override
+    {
+        vector<ConnectionId> ready;
+        vector<TimerEvent> timers;
+        bool replaysRunning = false;
+        while (true) //continuously handling events from connected clients
+        {
+            bool active = selector.wait(sf::milliseconds(replaysRunning ? 1.f : 10.f)); // waits for events on selector, briefly while history is streaming
+            lock_guard<mutex> lock(clientsMutex);
+
+            if (active)
             {
-                if (other.send(packet) != sf::Socket::Done)
+                //collecting ready clients first so handlers can close connections safely
+                ready.clear();
+                for (uint32_t slot = clients.first(); slot != NO_SLOT; slot = clients.next(slot))
+                {
+                    if (selector.isReady(clients.at(slot).socket))
+                    {
+                        ready.push_back(clients.idOf(slot));
+                    }
+                }
+                for (auto& id : ready) //every ready client is served, none are skipped
+                {
+                    if (clients.get(id) != nullptr) //may have been closed by an earlier handler
+                    {
+                        handleClient(id);
+                    }
+                }
+                if (selector.isReady(listener)) //accepting clients
+                {
+                    readyForClient();
+                }
+            }
+
+            timers.clear();
+            clients.advance(currentTick(), timers);
+            for (auto& timer : timers)
+            {
+                ConnectionId id = clients.idOf(timer.key);
+                if (clients.get(id) == nullptr) //closed by an earlier event
                 {
                     continue;
                 }
-                cont = false;
+                if (timer.idle) //no answer to the heartbeat
+                {
+                    cout << "Client timed out." << endl;
+                    closeConnection(id);
+                }
+                else
+                {
+                    sendHeartbeat(id);
+                }
             }
+
+            replaysRunning = advanceReplays();
+            flushAllBatches();
         }
     }
-}
+};
 
 int main(int argc, char* argv[])
 {
-    if (argc != 2) //checking for proper number of input arguments
+    if (argc < 2 || argc > 4) //checking for proper number of input arguments
     {
-        cout << "Usage: ./ServerTCP <port>" << endl;
+        cout << "Usage: ./ServerTCP <port> [log directory] [sfml|uring]" << endl;
         return 1;
     }
 
     unsigned short port = static_cast<unsigned short>(stoi(argv[1]));
+    signal(SIGPIPE, SIG_IGN); //sendfile has no MSG_NOSIGNAL, a client leaving mid-replay must not end the server
+    messageLog = new ECE_MessageLog(argc >= 3 ? argv[2] : "lab5_log"); //recovers history from earlier runs
 
-    if (listener.listen(port) != sf::Socket::Done) //start listening to incoming connections
+    string backend = argc == 4 ? argv[3] : "sfml";
+    if (backend == "uring") //kernel-driven loop, same heartbeats and idle timeouts
+    {
+        server = new ECE_UringServer(handleMessage, *messageLog);
+    }
+    else if (backend == "sfml")
+    {
+        server = new SfmlServer();
+    }
+    else
+    {
+        cout << "Backend must be sfml or uring." << endl;
+        return 1;
+    }
+
+    if (!server->listen(port))
     {
         return 0;
     }
@@ -124,13 +579,6 @@ int main(int argc, char* argv[])
     //BEGIN OPEN MP
 #pragma omp parallel sections
     {
-#pragma omp section
-        {
-            while (true)
-            {
-                readyForClient(); //accepting clients
-            }
-        }
 #pragma omp section
         {
             while (true)
@@ -140,10 +588,13 @@ int main(int argc, char* argv[])
 
                 //all options for server commands
                 if (command == "msg")
+                {
+                    lock_guard<mutex> lock(lastMessageMutex);
                     cout << "Last Message: " << lastMessageReceived.chMsg << endl;
+                }
                 else if (command == "clients")
                 {
-                    printConnectedClients();
+                    server->printClients();
                 }
                 else if (command == "exit")
                 {
@@ -159,55 +610,10 @@ int main(int argc, char* argv[])
         }
 #pragma omp section
         {
-            while (true) //continuously handling events from connected clients
-            {
-                if (selector.wait(sf::milliseconds(10.f))) // waits for events on selector
-                {
-                    for (list<sf::TcpSocket*>::iterator it = clients.begin(); it != clients.end(); ++it) //iterating over all clients
-                    {
-                        sf::TcpSocket& client = **it;
-                        if (selector.isReady(client))
-                        {
-                            if (client.receive(packet) == sf::Socket::Disconnected) //removes client if disconnected
-                            {
-                                selector.remove(client);
-                                client.disconnect();
-                                delete(&client);
-                                clients.erase(it);
-                                break;
-                            }
-                            packet >> lastMessageReceived.nVersion >> lastMessageReceived.nType >> lastMessageReceived.nMsgLen >> lastMessageReceived.chMsg; //receives packet from client
-
-                            //handles message based on version number
-                            if (lastMessageReceived.nVersion != 102) //version number 102
-                            {
-                                continue; //do nothing
-                            }
-                            else if (lastMessageReceived.nType == 201) //version number 201
-                            {
-                                processType201();
-                                //break;
-                                if (client.send(packet201) != sf::Socket::Done)
-                                {
-                                    continue;
-                                }
-                            }
-                            else if (lastMessageReceived.nType == 77) //version number 77
-                            {
-                                processType77(lastMessageReceived, client, clients);
-                            }
-                            else if (lastMessageReceived.nType == 1) //version number 77
-                            {
-                                cout << "Connection closed from client." << endl;
-                                exit(0);
-                            }
-                        }
-                    }
-                }
-            }
+            server->run(); //continuously handling events from connected clients
         }
     }
     //closing connection
     cout << "Closed server. Goodbye." << endl;
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,238 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for batched integration. A batch file lists one integral per line as
+    <g1|g2> <d> <a1> <b1> ... <ad> <bd>
+over the hyper-rectangle [a1, b1] x ... x [ad, bd], where g1 = |x|^2 and g2 = exp(-|x|^2)
+(the Lab6 integrands in one dimension). Integrals over the same domain share every random point,
+and the sums for the whole batch go through a single reduction.
+
+*/
+
+#ifndef LAB6_ECE_BATCH_H
+#define LAB6_ECE_BATCH_H
+
+//directives
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <mpi.h>
+#include <omp.h>
+#include "ECE_Philox.h"
+#include "ECE_KahanSum.h"
+#include "ECE_Integrands.h"
+
+const int MAX_DIMENSIONS = 16;
+
+struct IntegralSpec //one integral of the batch
+{
+    int integrand; //1 or 2
+    int dimensions;
+    double lower[MAX_DIMENSIONS];
+    double upper[MAX_DIMENSIONS];
+
+    [[nodiscard]] bool sameDomain(const IntegralSpec& other) const
+    {
+        return dimensions == other.dimensions && std::equal(lower, lower + dimensions, other.lower) &&
+               std::equal(upper, upper + dimensions, other.upper);
+    }
+
+    [[nodiscard]] double volume() const
+    {
+        double v = 1.0;
+        for (int k = 0; k < dimensions; k++)
+        {
+            v *= upper[k] - lower[k];
+        }
+        return v;
+    }
+};
+
+inline bool read_batch(const std::string& path, std::vector<IntegralSpec>& specs, std::string& error) //parses a batch file, false with error set on bad input
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        error = "Cannot open batch file " + path + ".";
+        return false;
+    }
+
+    std::string line;
+    int line_number = 0;
+    while (getline(file, line))
+    {
+        line_number++;
+        if (line.empty() || line[0] == '#') //blank lines and comments
+        {
+            continue;
+        }
+
+        std::istringstream fields(line);
+        std::string name;
+        IntegralSpec spec;
+        fields >> name >> spec.dimensions;
+        bool ok = (name == "g1" || name == "g2") && !fields.fail() && spec.dimensions >= 1 && spec.dimensions <= MAX_DIMENSIONS;
+        for (int k = 0; ok && k < spec.dimensions; k++)
+        {
+            fields >> spec.lower[k] >> spec.upper[k];
+            ok = !fields.fail() && spec.lower[k] < spec.upper[k];
+        }
+        if (!ok)
+        {
+            error = "Invalid batch line " + std::to_string(line_number) + ": " + line;
+            return false;
+        }
+        spec.integrand = (name == "g1") ? 1 : 2;
+        specs.push_back(spec);
+    }
+
+    if (specs.empty())
+    {
+        error = "Batch file " + path + " has no integrals.";
+        return false;
+    }
+    return true;
+}
+
+struct BatchResult //estimate of one integral of the batch
+{
+    double estimate;
+    double std_error;
+};
+
+//estimates every integral of specs with num_samples points per domain, results only valid on rank 0
+inline std::vector<BatchResult> calculate_batch(const std::vector<IntegralSpec>& specs, int64_t num_samples, uint64_t seed, int rank, int size)
+{
+    //grouping integrals by domain, each group shares its points
+    std::vector<int> group_of(specs.size());
+    std::vector<int> group_leader; //first spec of each group
+    for (size_t i = 0; i < specs.size(); i++)
+    {
+        size_t g = 0;
+        while (g < group_leader.size() && !specs[i].sameDomain(specs[group_leader[g]]))
+        {
+            g++;
+        }
+        if (g == group_leader.size())
+        {
+            group_leader.push_back(static_cast<int>(i));
+        }
+        group_of[i] = static_cast<int>(g);
+    }
+
+    int64_t proc_num_samples = num_samples / size + (rank < num_samples % size ? 1 : 0);
+    std::vector<KahanSum> local_sums(2 * specs.size()); //sum and sum of squares of every integral
+
+#pragma omp parallel
+    {
+        int thread = omp_get_thread_num();
+        int team = omp_get_num_threads();
+        int64_t first = proc_num_samples * thread / team;
+        int64_t last = proc_num_samples * (thread + 1) / team;
+
+        const int BATCH = 256; //points per pass
+        std::vector<double> u(BATCH * MAX_DIMENSIONS);
+        double r2[BATCH];
+        std::vector<KahanSum> thread_sums(2 * specs.size());
+
+        for (size_t g = 0; g < group_leader.size(); g++)
+        {
+            const IntegralSpec& domain = specs[group_leader[g]];
+            int d = domain.dimensions;
+            ECE_Philox rng(seed, (uint64_t(1) << 62) | (static_cast<uint64_t>(g) << 40) |
+                                 (static_cast<uint64_t>(rank) << 16) | static_cast<uint64_t>(thread)); //own stream per domain, rank and thread
+
+            for (int64_t i = first; i < last; i += BATCH)
+            {
+                int count = static_cast<int>(std::min<int64_t>(BATCH, last - i));
+                rng.uniforms(u.data(), static_cast<size_t>(count) * d); //coordinate k of point j is u[k * count + j]
+
+                //both integrands depend on the point only through |x|^2
+                std::fill(r2, r2 + count, 0.0);
+                for (int k = 0; k < d; k++)
+                {
+                    double lo = domain.lower[k];
+                    double w = domain.upper[k] - lo;
+                    const double* uk = u.data() + static_cast<size_t>(k) * count;
+#pragma omp simd
+                    for (int j = 0; j < count; ++j)
+                    {
+                        double x = lo + w * uk[j];
+                        r2[j] += x * x;
+                    }
+                }
+
+                for (size_t s = 0; s < specs.size(); s++) //every integral over this domain reuses the same points
+                {
+                    if (group_of[s] != static_cast<int>(g))
+                    {
+                        continue;
+                    }
+                    double s1 = 0.0, s2 = 0.0;
+                    if (specs[s].integrand == 1)
+                    {
+#pragma omp simd reduction(+:s1, s2)
+                        for (int j = 0; j < count; ++j)
+                        {
+                            double y = r2[j];
+                            s1 += y;
+                            s2 += y * y;
+                        }
+                    }
+                    else
+                    {
+#pragma omp simd reduction(+:s1, s2)
+                        for (int j = 0; j < count; ++j)
+                        {
+                            double y = simd_exp(-r2[j]);
+                            s1 += y;
+                            s2 += y * y;
+                        }
+                    }
+                    thread_sums[2 * s].add(s1);
+                    thread_sums[2 * s + 1].add(s2);
+                }
+            }
+        }
+
+#pragma omp for ordered schedule(static, 1)
+        for (int t = 0; t < team; t++) //combined in thread order so the result does not depend on scheduling
+        {
+#pragma omp ordered
+            for (size_t k = 0; k < local_sums.size(); k++)
+            {
+                local_sums[k].add(thread_sums[k]);
+            }
+        }
+    }
+
+    //one reduction carries every integral of the batch
+    MPI_Datatype kahan_type = make_kahan_type();
+    MPI_Op kahan_op;
+    MPI_Op_create(kahan_reduce, 1, &kahan_op);
+    std::vector<KahanSum> global_sums(local_sums.size());
+    MPI_Reduce(local_sums.data(), global_sums.data(), static_cast<int>(local_sums.size()), kahan_type, kahan_op, 0, MPI_COMM_WORLD);
+    MPI_Op_free(&kahan_op);
+    MPI_Type_free(&kahan_type);
+
+    std::vector<BatchResult> results(specs.size());
+    if (rank == 0)
+    {
+        double n = static_cast<double>(num_samples);
+        for (size_t s = 0; s < specs.size(); s++)
+        {
+            double mean = global_sums[2 * s].value() / n;
+            double variance = n > 1 ? (global_sums[2 * s + 1].value() - n * mean * mean) / (n - 1) : 0.0;
+            results[s].estimate = specs[s].volume() * mean;
+            results[s].std_error = specs[s].volume() * std::sqrt(std::max(variance, 0.0) / n);
+        }
+    }
+    return results;
+}
+
+#endif
@@ -0,0 +1,121 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for per-rank checkpoints of a run. A checkpoint holds the units a rank has finished,
+its compensated sums and the position of every thread's random stream, so a restarted run
+continues the same streams and produces the same estimate as one that was never interrupted.
+
+*/
+
+#ifndef LAB6_ECE_CHECKPOINT_H
+#define LAB6_ECE_CHECKPOINT_H
+
+//directives
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <sys/stat.h>
+#include <mpi.h>
+#include "ECE_Philox.h"
+#include "ECE_KahanSum.h"
+
+class ECE_Checkpoint //checkpoint file of one rank
+{
+public:
+    //run_key identifies the settings, a checkpoint written under other settings is never loaded
+    ECE_Checkpoint(const std::string& dir, double interval, uint64_t run_key, int rank)
+        : path(dir + "/lab6_rank" + std::to_string(rank) + ".ckpt"), interval(interval), run_key(run_key), last_save(MPI_Wtime())
+    {
+        mkdir(dir.c_str(), 0755); //fine if it already exists
+    }
+
+    bool load(int64_t& units_done, std::vector<KahanSum>& sums, std::vector<ECE_Philox>& rngs) const //false if there is no usable checkpoint
+    {
+        FILE* file = fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        Header header;
+        std::vector<KahanSum> saved_sums(sums.size());
+        std::vector<uint64_t> positions(rngs.size());
+        bool ok = fread(&header, sizeof(header), 1, file) == 1 && header.magic == MAGIC && header.run_key == run_key &&
+                  header.num_sums == sums.size() && header.num_streams == rngs.size() &&
+                  fread(saved_sums.data(), sizeof(KahanSum), saved_sums.size(), file) == saved_sums.size() &&
+                  fread(positions.data(), sizeof(uint64_t), positions.size(), file) == positions.size();
+        fclose(file);
+        if (!ok)
+        {
+            return false;
+        }
+
+        units_done = header.units_done;
+        sums = saved_sums;
+        for (size_t t = 0; t < rngs.size(); t++)
+        {
+            rngs[t].seek(positions[t]);
+        }
+        return true;
+    }
+
+    void save(int64_t units_done, const std::vector<KahanSum>& sums, const std::vector<ECE_Philox>& rngs) //written to a temporary file then renamed, so a crash mid-write keeps the old one
+    {
+        Header header = {MAGIC, run_key, units_done, sums.size(), rngs.size()};
+        std::vector<uint64_t> positions;
+        for (auto& rng : rngs)
+        {
+            positions.push_back(rng.position());
+        }
+
+        std::string temp = path + ".tmp";
+        FILE* file = fopen(temp.c_str(), "wb");
+        if (file == nullptr)
+        {
+            perror(temp.c_str());
+            return;
+        }
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                  fwrite(sums.data(), sizeof(KahanSum), sums.size(), file) == sums.size() &&
+                  fwrite(positions.data(), sizeof(uint64_t), positions.size(), file) == positions.size();
+        ok = (fclose(file) == 0) && ok;
+        if (!ok || rename(temp.c_str(), path.c_str()) != 0)
+        {
+            perror(path.c_str());
+        }
+        last_save = MPI_Wtime();
+    }
+
+    [[nodiscard]] bool due() const //interval has passed since the last save
+    {
+        return MPI_Wtime() - last_save >= interval;
+    }
+
+    void remove() const //run finished, nothing to resume
+    {
+        std::remove(path.c_str());
+    }
+
+private:
+    static const uint64_t MAGIC = 0x4C414236434B5054ull; //"LAB6CKPT"
+
+    struct Header
+    {
+        uint64_t magic;
+        uint64_t run_key;
+        int64_t units_done;
+        uint64_t num_sums;
+        uint64_t num_streams;
+    };
+
+    std::string path;
+    double interval; //seconds between saves
+    uint64_t run_key;
+    double last_save;
+};
+
+#endif
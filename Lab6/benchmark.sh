@@ -0,0 +1,73 @@
+#!/bin/bash
+#
+# Author: Abby McCollam
+# Class: ECE4122 Section A
+# Last Date Modified: 10/19/26
+# Description: Strong and weak scaling sweep of the Lab6 integrator on one node.
+#
+# Usage: ./benchmark.sh <Lab6 binary> [csv|json] [samples] [integrand] [max ranks] [max threads]
+#   strong scaling keeps [samples] fixed, weak scaling gives every rank x thread [samples] / 16
+#   writes strong_scaling.<format> and weak_scaling.<format> to the current directory
+
+PROGRAM=${1:?"Usage: ./benchmark.sh <Lab6 binary> [csv|json] [samples] [integrand] [max ranks] [max threads]"}
+FORMAT=${2:-csv}
+SAMPLES=${3:-100000000}
+INTEGRAND=${4:-2}
+MAX_RANKS=${5:-$(nproc)}
+MAX_THREADS=${6:-$(nproc)}
+SEED=12345 #fixed so every run samples the same streams
+
+if [ "$FORMAT" != "csv" ] && [ "$FORMAT" != "json" ]; then
+    echo "Format must be csv or json."
+    exit 1
+fi
+
+powers_of_two() #1 2 4 ... up to $1
+{
+    local n=1
+    while [ $n -le "$1" ]; do
+        echo $n
+        n=$((n * 2))
+    done
+}
+
+run_sweep() #run_sweep <output file> <weak|strong>
+{
+    local output=$1 first=1
+    if [ "$FORMAT" = "json" ]; then
+        echo "[" > "$output"
+    else
+        : > "$output"
+    fi
+    for ranks in $(powers_of_two "$MAX_RANKS"); do
+        for threads in $(powers_of_two "$MAX_THREADS"); do
+            local samples=$SAMPLES
+            if [ "$2" = "weak" ]; then
+                samples=$((SAMPLES / 16 * ranks * threads))
+            fi
+            #oversubscribed so a sweep past the core count still runs on one node
+            local record
+            record=$(mpirun --oversubscribe -np "$ranks" "$PROGRAM" -P "$INTEGRAND" -N "$samples" -S $SEED -T "$threads" -R "$FORMAT") || exit 1
+            if [ "$FORMAT" = "csv" ]; then
+                if [ $first -eq 1 ]; then
+                    echo "$record" >> "$output" #header once
+                else
+                    echo "$record" | sed 1d >> "$output"
+                fi
+            else
+                if [ $first -eq 0 ]; then
+                    echo "," >> "$output"
+                fi
+                echo "$record" >> "$output"
+            fi
+            first=0
+            echo "$2 scaling: $ranks ranks x $threads threads done"
+        done
+    done
+    if [ "$FORMAT" = "json" ]; then
+        echo "]" >> "$output"
+    fi
+}
+
+run_sweep "strong_scaling.$FORMAT" strong
+run_sweep "weak_scaling.$FORMAT" weak